@@ -0,0 +1,90 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See animationplayer.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _ANIMATIONPLAYER_H_
+#define _ANIMATIONPLAYER_H_
+
+#include <stdint.h>
+#include <pgmspace.h>
+#include <LittleFS.h>
+#include "config.h"
+
+#define ANIMATIONMAGIC 0x31414357   // "WCA1"
+#define ANIMATIONMAXCOLORS 16       // palette is copied by set(), see FRAME_PALETTE_SIZE
+#define ANIMATIONKEEP 0xFF          // color index of a run that keeps the previous frame
+#define ANIMATIONREADAHEAD 64       // bytes read from the file at once
+#define ANIMATIONPATHSIZE CONFIGSTRINGSIZE
+
+// animation flags
+#define ANIMATION_LOOP 0x01         // start over after the last frame, else hold it
+#define ANIMATION_FADE 0x02         // fade to each frame instead of showing it immediately
+
+// header of an animation file, followed by colors palette entries and the frames
+typedef struct _animation_header
+{
+	uint32_t magic;
+	uint16_t frameCount;
+	uint8_t colors;                 // palette entries, 1..ANIMATIONMAXCOLORS
+	uint8_t flags;                  // ANIMATION_xxx
+} animation_header;
+
+// header of a frame, followed by length bytes of (count, index) runs which cover all
+// NUM_PIXELS LEDs in the order of LEDFunctionsClass::set()
+typedef struct _animation_frame
+{
+	uint16_t duration;              // ms until the next frame
+	uint16_t length;
+} animation_frame;
+
+class AnimationPlayer
+{
+public:
+	~AnimationPlayer();
+	bool open(const char *path);
+	bool open(const uint8_t *data, uint32_t size);
+	void close();
+	bool isOpen();
+	bool fades();
+	bool nextFrame(uint8_t *frame, uint16_t &duration);
+	bool isPath(const char *path);
+
+	animation_header header;
+	palette_entry palette[ANIMATIONMAXCOLORS];
+
+private:
+	bool start();
+	int readByte();
+	bool readBytes(uint8_t *target, int count);
+	const char *name();
+	bool decodeFrame(uint8_t *frame, uint16_t &duration);
+	void rewind();
+
+	File file;
+	const uint8_t *data = nullptr;  // PROGMEM animation instead of file
+	uint32_t dataSize = 0;
+	uint32_t dataPos = 0;
+	char path[ANIMATIONPATHSIZE] = "";
+	bool valid = false;
+	uint32_t firstFrame = 0;        // file offset of the first frame
+	uint16_t frameIndex = 0;
+	uint8_t buffer[ANIMATIONREADAHEAD];
+	uint8_t bufferPos = 0;
+	uint8_t bufferFill = 0;
+};
+
+#endif /* _ANIMATIONPLAYER_H_ */
@@ -23,10 +23,19 @@
 
 // constants
 #define NUM_PIXELS 114
-#define EEPROM_SIZE 512
+#define NUM_PIXELS_ALIGNED ((NUM_PIXELS + 3) & ~0x03) // indexed buffers padded to 32 bit
+#define EEPROM_SIZE 512                           // size of the legacy EEPROM config
 #define CONFIGWRITETIMEOUT 10000
 #define CONFIGSTRINGSIZE 25
-#define CONFIGFILE  "/config.json"                // name of the config file on the SPIFFS image
+#define CONFIGFILE  "/config.json"                // legacy JSON copy of the config, removed on migration
+#define CONFIGRECORDFILE "/config.bin"            // binary config record on LittleFS
+#define CONFIGTEMPFILE "/config.tmp"              // new record is written here first, then renamed
+#define CONFIGRECORDMAGIC 0x47464357              // "WCFG"
+#define CONFIGJOURNALFILE "/config.jnl"           // changes since the config record was written
+#define CONFIGJOURNALMAGIC 0x4C4A4357             // "WCJL"
+#define CONFIGJOURNALSIZE 1024                    // journal is compacted into the record when full
+#define ANIMATIONFILE "/animation.wca"            // default animation file
+#define CONFIGVERSION 2                           // 1 = legacy EEPROM layout
 
 
 enum class DisplayMode
@@ -35,7 +44,8 @@ enum class DisplayMode
   random, matrix, heart, fire, plasma, stars, wakeup, HorizontalStripes, VerticalStripes,
   RandomDots, RandomStripes, RotatingLine, red, green, blue,
   yellowHourglass, greenHourglass, update, updateComplete, updateError,
-  wifiManager, christmastree, jinglebells, merryChristmas, happyNewYear, invalid
+  wifiManager, christmastree, jinglebells, merryChristmas, happyNewYear, animation,
+  scrollText, invalid
 };
 
 enum class AlarmType
@@ -43,6 +53,33 @@ enum class AlarmType
   oneoff, always, weekend, workingdays
 };
 
+// curves for fading between two frames, stepped is the original fixed step fade
+enum class FadeEasing
+{
+  stepped, linear, gamma, easeInOut, invalid
+};
+
+#define FADEDURATION_MIN 50
+#define FADEDURATION_MAX 10000
+
+// transitions between two display modes, see LEDFunctionsClass::setMode()
+enum class TransitionType
+{
+  none, crossfade, wipe, dissolve, invalid
+};
+
+#define TRANSITIONDURATION_MIN 100
+#define TRANSITIONDURATION_MAX 5000
+
+// levels of Config.logLevel, messages of higher levels are not printed
+#define LOG_ERROR 0                               // errors only, these are always printed
+#define LOG_INFO 1                                // progress of network, config and effects
+#define LOG_DEBUG 2                               // frame dumps
+
+#define FIRECOOLING_MAX 100
+#define FIRESPARKING_MAX 100
+#define FIREWIND_MAX 100                          // wind is -FIREWIND_MAX..FIREWIND_MAX
+
 // structure to encapsulate a color value with red, green and blue values
 typedef struct _palette_entry
 {
@@ -57,7 +94,9 @@ typedef struct _alarm
   AlarmType type;
 } t_alarm;
 
-// structure with configuration data to be stored in EEPROM
+// structure with configuration data to be stored in the config record. New fields
+// must be appended at the end, records written by older versions are shorter and
+// the missing fields keep their defaults when loaded.
 typedef struct _config_struct
 {
 	uint32_t magic;
@@ -80,8 +119,42 @@ typedef struct _config_struct
   bool usemqttauthentication = false;
   char mqttuser[CONFIGSTRINGSIZE];
   char mqttpass[CONFIGSTRINGSIZE];
+  uint16_t fadeDuration;
+  uint8_t fadeEasing;
+  bool dithering;
+  uint8_t matrixDensity;
+  uint8_t fireCooling;
+  uint8_t fireSparking;
+  int8_t fireWind;
+  char animationFile[CONFIGSTRINGSIZE];
+  uint8_t transition;
+  uint16_t transitionDuration;
 } config_struct;
 
+// header of the config record file, followed by the config_struct payload
+typedef struct _config_header
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t length;                // size of the payload in bytes
+  uint32_t crc;                   // CRC-32 of the payload
+} config_header;
+
+// header of the config journal file
+typedef struct _journal_header
+{
+  uint32_t magic;
+  uint32_t recordCrc;             // CRC of the config record the journal applies to
+} journal_header;
+
+// header of a journal entry, followed by length bytes to be copied to offset
+typedef struct _journal_entry
+{
+  uint16_t offset;
+  uint16_t length;
+  uint16_t check;                 // lower 16 bits of CRC-32 over offset, length and data
+} journal_entry;
+
 class ConfigClass
 {
 public:
@@ -104,6 +177,7 @@ public:
 	IPAddress ntpserver = IPAddress(0, 0, 0, 0);
 	bool heartbeat = true;
 	bool debugMode = false;
+	uint8_t logLevel = LOG_INFO; // not stored, see /setloglevel
   bool nightmode = false;
 
 	// DisplayMode defaultMode = DisplayMode::explode;
@@ -129,10 +203,50 @@ public:
   char mqttuser[CONFIGSTRINGSIZE];
   char mqttpass[CONFIGSTRINGSIZE];
 
+  // fading
+  int fadeDuration = 900; // ms, FADEDURATION_MIN..FADEDURATION_MAX
+  FadeEasing fadeEasing = FadeEasing::easeInOut;
+
+  // carry the fraction lost by the brightness scaling over to the next frames
+  bool dithering = false;
+
+  // chance of a new drop in an empty column of the matrix effect
+  uint8_t matrixDensity = 50; // value from 1..100
+
+  // fire effect
+  uint8_t fireCooling = 15;   // heat lost per row, 0..FIRECOOLING_MAX
+  uint8_t fireSparking = 30;  // chance of a spark per bottom LED and frame in %
+  int8_t fireWind = 0;        // columns per 100 frames the flames drift, negative = left
+
+  // file played by DisplayMode::animation
+  char animationFile[CONFIGSTRINGSIZE];
+
+  // switching between display modes
+  TransitionType transition = TransitionType::crossfade;
+  int transitionDuration = 600; // ms, TRANSITIONDURATION_MIN..TRANSITIONDURATION_MAX
+
+  static const char *fadeEasingName(FadeEasing easing);
+  static FadeEasing fadeEasingFromName(const char *name);
+  static const char *transitionName(TransitionType transition);
+  static TransitionType transitionFromName(const char *name);
+
 private:
-	// copy of EEPROM content
-	config_struct *config = (config_struct*) eeprom_data;
-	uint8_t eeprom_data[EEPROM_SIZE];
+  void store();
+  bool readRecord(bool &migrate);
+  bool writeRecord();
+  bool migrateEEPROM();
+  void clearEEPROM();
+  bool replayJournal();
+  bool appendJournal(const config_struct &previous);
+  bool compact();
+  uint16_t entryCheck(const journal_entry &entry, const uint8_t *data);
+
+  uint32_t recordCrc = 0;
+  uint32_t journalSize = 0;
+
+	// copy of the stored config record
+	config_struct data;
+	config_struct *config = &data;
 };
 
 extern ConfigClass Config;
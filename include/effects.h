@@ -0,0 +1,119 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See effects.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _EFFECTS_H_
+#define _EFFECTS_H_
+
+#include <stdint.h>
+#include "config.h"
+#include "starobject.h"
+
+class LEDFunctionsClass;
+class AnimationPlayer;
+class ScrollText;
+
+#define NUM_EFFECTS ((int)DisplayMode::invalid)
+#define EFFECT_WIDTH 11                 // LEDFunctionsClass::width
+#define EFFECT_HEIGHT 10                // LEDFunctionsClass::height
+
+// effect flags
+#define EFFECT_INDEXED    0x01  // only shows indexed frames, see LEDFunctionsClass::set()
+#define EFFECT_NIGHTPLAIN 0x02  // shows the plain time (indexed) in night mode
+#define EFFECT_ALARM      0x04  // can be selected for an alarm
+#define EFFECT_STATE      0x08  // needs an effect_state while active
+#define EFFECT_NOTRANSITION 0x10 // switched to and from without transition
+#define EFFECT_ANIMATION  0x20  // plays state->animation, not indexed while the animation fades
+
+// registry entry of an effect
+typedef struct _effect_descriptor
+{
+	DisplayMode mode;
+	const char *name;               // used by MQTT and the alarm settings
+	int8_t webId;                   // index in the mode list of the web page, -1 = none
+	uint8_t flags;                  // EFFECT_xxx
+	uint16_t interval;              // ms between frames, 0 = render() throttles itself
+	void (LEDFunctionsClass::*init)();
+	void (LEDFunctionsClass::*render)();
+	void (LEDFunctionsClass::*teardown)();
+} effect_descriptor;
+
+// letter of the flying letters effect, moves vertically from y to yTarget
+typedef struct _flying_letter
+{
+	int8_t x, y, yTarget;
+	uint8_t delay;                  // steps to wait before moving
+	int16_t counter;                // progress of the current step in 1/1000
+} flying_letter;
+
+// state of the active effect. All effects share this block: it is allocated while an
+// effect with EFFECT_STATE is active and zeroed by setMode() before init() is called,
+// so it only needs as much RAM as the largest member.
+typedef union _effect_state
+{
+	struct
+	{
+		flying_letter arriving[EFFECT_WIDTH * EFFECT_HEIGHT]; // letters of the current time
+		flying_letter leaving[EFFECT_WIDTH * EFFECT_HEIGHT];  // letters of the previous time
+		uint8_t arrivingCount, leavingCount;
+	} flyingLetters;
+	struct
+	{
+		uint8_t buf[NUM_PIXELS_ALIGNED]; // heat per LED, indexed frame aligned for set()
+		uint32_t rng;                   // xorshift state
+		int16_t windPhase;              // wind accumulated since the last column shift
+	} fire;
+	struct
+	{
+		uint8_t buf[NUM_PIXELS_ALIGNED]; // indexed frame, aligned for set()
+		double time;
+	} plasma;
+	struct
+	{
+		uint8_t intensity[EFFECT_WIDTH * EFFECT_HEIGHT]; // x + y * width, 255 = drop head
+		int16_t head[EFFECT_WIDTH];     // row of the drop head in 1/256 rows
+		uint8_t speed[EFFECT_WIDTH];    // 1/256 rows per frame, 0 = no drop in column
+	} matrix;
+	struct
+	{
+		StarObject star[NUM_STARS];
+		uint8_t blocked[EFFECT_WIDTH * EFFECT_HEIGHT]; // stars too close to a cell, see StarObject::mark()
+	} stars;
+	struct
+	{
+		uint8_t frame[NUM_PIXELS_ALIGNED]; // indexed frame, aligned for set()
+		AnimationPlayer *player;
+		unsigned long lastFrame;
+		uint16_t duration;              // ms until the next frame
+		uint16_t serial;                // animationSerial of the open file
+	} animation;
+	struct
+	{
+		int brightness, state;
+	} heart;
+	struct
+	{
+		int x1, y1, x2, y2;
+	} line;
+	struct
+	{
+		uint8_t frame[NUM_PIXELS_ALIGNED]; // indexed frame, aligned for set()
+		ScrollText *scroll;
+		uint16_t serial;                // notification shown, see LEDFunctionsClass::showText()
+	} text;
+} effect_state;
+
+#endif
@@ -0,0 +1,104 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Fade step of LEDFunctionsClass::fadeStepped(), kept free of the Arduino core so the
+//  host test in test/host can check the packed version against the scalar one.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _FADESTEP_H_
+#define _FADESTEP_H_
+
+#include <stdint.h>
+
+//---------------------------------------------------------------------------------------
+// fadeLanes
+//
+// One fade step for two color values at once, each held in the lower 8 bits of a
+// 16 bit lane (mask 0x00FF00FF). Branch free version of the step ladder in fadeByte():
+//  - d = 0x100 + target - current is 1..511, so the lanes never borrow from each other
+//    and bit 8 tells the direction
+//  - the distance a is taken from the lower 8 bits (negated for negative lanes)
+//  - adding 0xFF/0xEF/0xBF/0x7F sets bit 8 if a > 0/16/64/128, the steps 1/8/16/32
+//    are built from these as 1 + 7 + 8 + 16
+//  - the step never exceeds the distance, so adding or subtracting it stays in 8 bits
+//
+// -> c: current values
+//    t: target values
+// <- new current values
+//---------------------------------------------------------------------------------------
+static inline uint32_t fadeLanes(uint32_t c, uint32_t t)
+{
+	uint32_t d = (t | 0x01000100UL) - c;
+	uint32_t pos = (d >> 8) & 0x00010001UL;
+	uint32_t neg = pos ^ 0x00010001UL;
+	uint32_t a = ((d & 0x00FF00FFUL) ^ (neg * 0xFF)) + neg;
+	uint32_t step = (((a + 0x00FF00FFUL) >> 8) & 0x00010001UL)
+		+ 7 * (((a + 0x00EF00EFUL) >> 8) & 0x00010001UL)
+		+ 8 * (((a + 0x00BF00BFUL) >> 8) & 0x00010001UL)
+		+ 16 * (((a + 0x007F007FUL) >> 8) & 0x00010001UL);
+	return c + (step & (pos * 0xFF)) - (step & (neg * 0xFF));
+}
+
+//---------------------------------------------------------------------------------------
+// fadeByte
+//
+// One fade step for a single color value, the reference for fadeLanes()
+//
+// -> c: current value
+//    t: target value
+// <- new current value
+//---------------------------------------------------------------------------------------
+static inline uint8_t fadeByte(uint8_t c, uint8_t t)
+{
+	int delta = t - c;
+	if (delta > 128) return c + 32;
+	if (delta > 64) return c + 16;
+	if (delta > 16) return c + 8;
+	if (delta > 0) return c + 1;
+	if (delta < -128) return c - 32;
+	if (delta < -64) return c - 16;
+	if (delta < -16) return c - 8;
+	if (delta < 0) return c - 1;
+	return c;
+}
+
+//---------------------------------------------------------------------------------------
+// fadeStep
+//
+// One fade step for a buffer of color values, four per 32 bit word with fadeLanes(),
+// the remainder with fadeByte()
+//
+// -> current: current values, 32 bit aligned
+//    target: target values, 32 bit aligned
+//    count: number of color values
+// <- --
+//---------------------------------------------------------------------------------------
+static inline void fadeStep(uint8_t *current, const uint8_t *target, int count)
+{
+	uint32_t *c32 = (uint32_t*) current;
+	const uint32_t *t32 = (const uint32_t*) target;
+	const int words = count / 4;
+	for (int i = 0; i < words; i++)
+	{
+		uint32_t c = c32[i], t = t32[i];
+		c32[i] = fadeLanes(c & 0x00FF00FFUL, t & 0x00FF00FFUL) |
+			(fadeLanes((c >> 8) & 0x00FF00FFUL, (t >> 8) & 0x00FF00FFUL) << 8);
+	}
+	for (int i = words * 4; i < count; i++)
+	{
+		current[i] = fadeByte(current[i], target[i]);
+	}
+}
+
+#endif
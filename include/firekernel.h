@@ -1,7 +1,7 @@
 // ESP8266 Wordclock
 // Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
 //
-//  See MatrixObject.cpp for description.
+//  See firekernel.cpp for description.
 //
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -15,33 +15,15 @@
 //
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _FIREKERNEL_H_
+#define _FIREKERNEL_H_
 
-#ifndef _MATRIXOBJECT_H_
-#define _MATRIXOBJECT_H_
+#include <stdint.h>
 
-#include <vector>
-#include <algorithm>
-#include "config.h"
+#define FIRE_MAXWIDTH 32  // widest matrix fireStep() can handle
+#define FIRE_WINDSTEP 100 // accumulated wind that shifts the source row by one column
 
-class MatrixObject
-{
-public:
-	bool operator<(const MatrixObject &other) const { return other.y < this->y; }
-	void render(uint8_t *buf);
-	MatrixObject();
+void fireStep(uint8_t *buf, int w, int h, uint32_t &rng, int16_t &windPhase,
+	int wind, int sparking, int cooling);
 
-private:
-	void randomize();
-	void move();
-
-	static const std::vector<palette_entry> MatrixGradient;
-	static const int MinMatrixSpeed = 1000;
-	static const int MaxMatrixSpeed = 6000;
-
-	int speed = MatrixObject::MinMatrixSpeed;
-	int prescaler = 0;
-	int x = 0;
-	int y = 0;
-};
-
-#endif /* _MATRIXOBJECT_H_ */
+#endif
@@ -0,0 +1,142 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  This file contains the font for scrolling text, 10 pixels high with glyphs of
+//  variable width for the printable ASCII characters. Capital letters and digits use
+//  rows 0-9, lowercase letters rows 3-8 with ascenders from row 0 and descenders down
+//  to row 9. Each column is stored as a bit mask, bit 0 = top row. This is not a
+//  regular header file, it must be included only once from scrolltext.cpp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _FONT_5X10_INC_
+#define _FONT_5X10_INC_
+
+#include <stdint.h>
+
+#define FONT_FIRST ' '
+#define FONT_LAST '~'
+
+// columns of all glyphs, left to right
+static const uint16_t PROGMEM font_columns[] = {
+	0x000, 0x000, 0x000, // ' '
+	0x2FF, // '!'
+	0x007, 0x000, 0x007, // '"'
+	0x048, 0x1FE, 0x048, 0x1FE, 0x048, // '#'
+	0x08C, 0x092, 0x1FF, 0x092, 0x062, // '$'
+	0x103, 0x0C3, 0x030, 0x30C, 0x302, // '%'
+	0x1E6, 0x219, 0x229, 0x1C6, 0x220, // '&'
+	0x007, // '\''
+	0x0FC, 0x102, 0x201, // '('
+	0x201, 0x102, 0x0FC, // ')'
+	0x02A, 0x01C, 0x03E, 0x01C, 0x02A, // '*'
+	0x010, 0x010, 0x07C, 0x010, 0x010, // '+'
+	0x200, 0x100, // ','
+	0x010, 0x010, 0x010, 0x010, // '-'
+	0x200, // '.'
+	0x300, 0x0C0, 0x030, 0x00C, 0x003, // '/'
+	0x1FE, 0x241, 0x231, 0x209, 0x1FE, // '0'
+	0x202, 0x3FF, 0x200, // '1'
+	0x382, 0x241, 0x221, 0x211, 0x20E, // '2'
+	0x102, 0x201, 0x211, 0x211, 0x1EE, // '3'
+	0x038, 0x024, 0x022, 0x3FF, 0x020, // '4'
+	0x10F, 0x209, 0x209, 0x209, 0x1F1, // '5'
+	0x1FE, 0x209, 0x209, 0x209, 0x1F0, // '6'
+	0x001, 0x001, 0x3E1, 0x019, 0x007, // '7'
+	0x1EE, 0x211, 0x211, 0x211, 0x1EE, // '8'
+	0x01E, 0x221, 0x221, 0x221, 0x1FE, // '9'
+	0x108, // ':'
+	0x200, 0x108, // ';'
+	0x010, 0x028, 0x044, 0x082, // '<'
+	0x048, 0x048, 0x048, 0x048, // '='
+	0x082, 0x044, 0x028, 0x010, // '>'
+	0x002, 0x001, 0x2E1, 0x011, 0x00E, // '?'
+	0x1FE, 0x201, 0x279, 0x249, 0x13E, // '@'
+	0x3FE, 0x011, 0x011, 0x011, 0x3FE, // 'A'
+	0x3FF, 0x211, 0x211, 0x211, 0x1EE, // 'B'
+	0x1FE, 0x201, 0x201, 0x201, 0x102, // 'C'
+	0x3FF, 0x201, 0x201, 0x201, 0x1FE, // 'D'
+	0x3FF, 0x211, 0x211, 0x211, 0x201, // 'E'
+	0x3FF, 0x011, 0x011, 0x011, 0x001, // 'F'
+	0x1FE, 0x201, 0x221, 0x221, 0x1E2, // 'G'
+	0x3FF, 0x010, 0x010, 0x010, 0x3FF, // 'H'
+	0x201, 0x3FF, 0x201, // 'I'
+	0x180, 0x200, 0x201, 0x1FF, 0x001, // 'J'
+	0x3FF, 0x018, 0x024, 0x0C2, 0x301, // 'K'
+	0x3FF, 0x200, 0x200, 0x200, 0x200, // 'L'
+	0x3FF, 0x002, 0x004, 0x002, 0x3FF, // 'M'
+	0x3FF, 0x006, 0x018, 0x060, 0x3FF, // 'N'
+	0x1FE, 0x201, 0x201, 0x201, 0x1FE, // 'O'
+	0x3FF, 0x011, 0x011, 0x011, 0x00E, // 'P'
+	0x1FE, 0x201, 0x281, 0x101, 0x2FE, // 'Q'
+	0x3FF, 0x011, 0x031, 0x051, 0x38E, // 'R'
+	0x10E, 0x211, 0x211, 0x211, 0x1E2, // 'S'
+	0x001, 0x001, 0x3FF, 0x001, 0x001, // 'T'
+	0x1FF, 0x200, 0x200, 0x200, 0x1FF, // 'U'
+	0x03F, 0x0C0, 0x300, 0x0C0, 0x03F, // 'V'
+	0x3FF, 0x080, 0x070, 0x080, 0x3FF, // 'W'
+	0x303, 0x0CC, 0x030, 0x0CC, 0x303, // 'X'
+	0x007, 0x008, 0x3F0, 0x008, 0x007, // 'Y'
+	0x301, 0x2C1, 0x231, 0x20D, 0x203, // 'Z'
+	0x3FF, 0x201, // '['
+	0x003, 0x00C, 0x030, 0x0C0, 0x300, // '\\'
+	0x201, 0x3FF, // ']'
+	0x004, 0x002, 0x001, 0x002, 0x004, // '^'
+	0x200, 0x200, 0x200, 0x200, 0x200, // '_'
+	0x001, 0x002, // '`'
+	0x0C0, 0x128, 0x128, 0x0A8, 0x1F0, // 'a'
+	0x1FF, 0x110, 0x108, 0x108, 0x0F0, // 'b'
+	0x0F0, 0x108, 0x108, 0x108, 0x090, // 'c'
+	0x0F0, 0x108, 0x108, 0x110, 0x1FF, // 'd'
+	0x0F0, 0x128, 0x128, 0x128, 0x0B0, // 'e'
+	0x008, 0x1FE, 0x009, 0x001, // 'f'
+	0x030, 0x248, 0x248, 0x248, 0x1F8, // 'g'
+	0x1FF, 0x010, 0x008, 0x008, 0x1F0, // 'h'
+	0x108, 0x1FA, 0x100, // 'i'
+	0x100, 0x208, 0x1FA, // 'j'
+	0x1FF, 0x020, 0x050, 0x188, // 'k'
+	0x101, 0x1FF, 0x100, // 'l'
+	0x1F8, 0x010, 0x0E0, 0x010, 0x1F8, // 'm'
+	0x1F8, 0x010, 0x008, 0x008, 0x1F0, // 'n'
+	0x0F0, 0x108, 0x108, 0x108, 0x0F0, // 'o'
+	0x3F8, 0x048, 0x048, 0x048, 0x030, // 'p'
+	0x030, 0x048, 0x048, 0x048, 0x3F8, // 'q'
+	0x1F8, 0x010, 0x008, 0x008, 0x010, // 'r'
+	0x090, 0x128, 0x128, 0x128, 0x0C0, // 's'
+	0x008, 0x008, 0x0FE, 0x108, 0x088, // 't'
+	0x0F8, 0x100, 0x100, 0x080, 0x1F8, // 'u'
+	0x038, 0x0C0, 0x100, 0x0C0, 0x038, // 'v'
+	0x1F8, 0x080, 0x060, 0x080, 0x1F8, // 'w'
+	0x108, 0x090, 0x060, 0x090, 0x108, // 'x'
+	0x038, 0x240, 0x240, 0x120, 0x0F8, // 'y'
+	0x188, 0x148, 0x128, 0x118, 0x108, // 'z'
+	0x010, 0x1EE, 0x201, 0x201, // '{'
+	0x3FF, // '|'
+	0x201, 0x201, 0x1EE, 0x010, // '}'
+	0x020, 0x010, 0x010, 0x020, 0x010 // '~'
+};
+
+// index of the first column of each glyph in font_columns, the width of glyph i is
+// font_offsets[i + 1] - font_offsets[i]
+static const uint16_t PROGMEM font_offsets[FONT_LAST - FONT_FIRST + 2] = {
+	0, 3, 4, 7, 12, 17, 22, 27, 28, 31, 34, 39,
+	44, 46, 50, 51, 56, 61, 64, 69, 74, 79, 84, 89,
+	94, 99, 104, 105, 107, 111, 115, 119, 124, 129, 134, 139,
+	144, 149, 154, 159, 164, 169, 172, 177, 182, 187, 192, 197,
+	202, 207, 212, 217, 222, 227, 232, 237, 242, 247, 252, 257,
+	259, 264, 266, 271, 276, 278, 283, 288, 293, 298, 303, 307,
+	312, 317, 320, 323, 327, 330, 335, 340, 345, 350, 355, 360,
+	365, 370, 375, 380, 385, 390, 395, 400, 404, 405, 409, 414
+};
+
+#endif
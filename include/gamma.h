@@ -0,0 +1,56 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See gamma.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _GAMMA_H_
+#define _GAMMA_H_
+
+#include <stdint.h>
+#include <pgmspace.h>
+
+#define GAMMA_LINEAR_MAX 4095
+
+extern const uint16_t PROGMEM gammaDecodeTable[256];
+extern const uint8_t PROGMEM gammaEncodeTable[GAMMA_LINEAR_MAX + 1];
+
+// 8 bit sRGB value -> linear light 0..GAMMA_LINEAR_MAX
+static inline int32_t gammaDecode(uint8_t value)
+{
+	return pgm_read_word(&gammaDecodeTable[value]);
+}
+
+// linear light 0..GAMMA_LINEAR_MAX -> 8 bit sRGB value
+static inline uint8_t gammaEncode(int32_t linear)
+{
+	return pgm_read_byte(&gammaEncodeTable[linear]);
+}
+
+// blends from a to b in linear light, weight 0..256 (256 = b)
+static inline uint8_t gammaBlend(uint8_t a, uint8_t b, uint32_t weight)
+{
+	int32_t la = gammaDecode(a);
+	return gammaEncode(la + (((gammaDecode(b) - la) * (int32_t)weight) >> 8));
+}
+
+// adds b scaled by weight 0..256 to a in linear light, limited to max
+static inline uint8_t gammaAdd(uint8_t a, uint8_t b, uint32_t weight, uint8_t max)
+{
+	int32_t l = gammaDecode(a) + ((gammaDecode(b) * (int32_t)weight) >> 8);
+	int32_t lmax = gammaDecode(max);
+	return gammaEncode(l > lmax ? lmax : l);
+}
+
+#endif
@@ -1,8 +1,10 @@
 // ESP8266 Wordclock
 // Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
 //
-//  This file contains the hourglass animation. This is not a regular header file,
-//  it must be included only once from ledfunctions.cpp.
+//  This file contains the hourglass animation in the animation file format (see
+//  animationplayer.cpp): a key frame followed by frames which only encode the LEDs
+//  that changed. This is not a regular header file, it must be included only once
+//  from ledfunctions.cpp.
 //
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -20,103 +22,31 @@
 #define _HOURGLASS_ANIMATION_INC_
 
 #include <stdint.h>
-#include "config.h"
-#define HOURGLASS_ANIMATION_PERIOD 100
-#define HOURGLASS_ANIMATION_FRAMES 8
+#include "animationplayer.h"
 
-// animation frames for hourglass animation
-// second dimension is NUM_PIXELS+2 to guarantee each frame starts at
-// a 32 bit boundary
-#define NUM_PIXELS_ALIGNED ((NUM_PIXELS + 3) & ~0x03)
-static const uint8_t  __attribute__((aligned(4))) PROGMEM hourglass_animation[HOURGLASS_ANIMATION_FRAMES][NUM_PIXELS_ALIGNED] = {
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 2, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 2, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 2, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0},
-	{   0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 0, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 2, 2, 2, 1, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
-		0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0,
-		0, 0, 1, 0, 2, 2, 2, 0, 1, 0, 0,
-		0, 0, 1, 2, 2, 2, 2, 2, 1, 0, 0,
-		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-		3, 3, 3, 3, 0, 0}
+// hourglass animation, played by AnimationPlayer directly from PROGMEM
+static const uint8_t PROGMEM hourglass_animation[] = {
+	// header: "WCA1", 4 frames, 4 colors, ANIMATION_LOOP
+	'W', 'C', 'A', '1', 4, 0, 4, ANIMATION_LOOP,
+	// palette: black, white, yellow, yellow (made green by initHourglass() for the green hourglass)
+	0, 0, 0, 255, 255, 255, 255, 255, 0, 255, 255, 0,
+	// frame 0: key frame, 100 ms
+	100, 0, 84, 0,
+	3, 0, 5, 1, 5, 0, 1, 1, 5, 0, 1, 1, 4, 0, 1, 1,
+	2, 2, 1, 0, 2, 2, 1, 1, 5, 0, 1, 1, 3, 2, 1, 1,
+	7, 0, 1, 1, 1, 2, 1, 1, 8, 0, 1, 1, 1, 0, 1, 1,
+	7, 0, 1, 1, 3, 0, 1, 1, 5, 0, 1, 1, 1, 0, 3, 2,
+	1, 0, 1, 1, 4, 0, 1, 1, 5, 2, 1, 1, 5, 0, 5, 1,
+	3, 0, 4, 3,
+	// frame 1: sand grain falls, 100 ms
+	100, 0, 10, 0,
+	49, 0xFF, 1, 0, 10, 0xFF, 1, 2, 53, 0xFF,
+	// frame 2: sand grain leaves the neck, 100 ms
+	100, 0, 10, 0,
+	60, 0xFF, 1, 0, 10, 0xFF, 1, 2, 42, 0xFF,
+	// frame 3: sand grain gone, 500 ms
+	244, 1, 6, 0,
+	71, 0xFF, 1, 0, 42, 0xFF
 };
 
 #endif
@@ -19,6 +19,10 @@
 #define _WEBSERVER_H_
 // #define DEBUG
 
+// use the event driven backend (ESPAsyncWebServer) instead of ESP8266WebServer, so
+// slow clients and large files do not block the main loop
+#define ASYNCWEBSERVER
+
 #include <stdint.h>
 #ifdef ESP32
 // #include <Wifi.h>
@@ -29,6 +33,9 @@
 #endif
 #include "config.h"
 #include <LittleFS.h>               // Filesystem
+#ifdef ASYNCWEBSERVER
+#include "webbackend.h"
+#endif
 
 // uploadform
 const char HTTP_UPLOAD_FORM[] PROGMEM = "<form method=\"post\" enctype=\"multipart/form-data\"><input type=\"file\" name=\"name\"><input class=\"button\" type=\"submit\" value=\"Upload\"></form><br /><a href=\"/\">Back to main page</a>";
@@ -62,7 +69,9 @@ public:
 	void process();
 
 private:
-#ifdef ESP32
+#if defined(ASYNCWEBSERVER)
+	AsyncWebBackend *server = NULL;
+#elif defined(ESP32)
    WebServer *server = NULL;
 #else
 	ESP8266WebServer *server = NULL;
@@ -70,6 +79,7 @@ private:
 
   // object for uploading files
   File fsUploadFile;
+  uint32_t uploadCrc = 0;
 
 
 	bool serveFile(const char url[]);
@@ -93,8 +103,19 @@ private:
   void handleSetAlarm();
   void handleSetHostname();
   void handleSetAnimSpeed();
+  void handleSetFade();
+  void handleSetTransition();
+  void handleSetDithering();
+  void handleSetMatrixDensity();
+  void handleSetFire();
+  void handleSetAnimation();
+  void handleShowText();
+  void handleSetLogLevel();
+  void handleLoadCalibration();
+  void handleClearCalibration();
   void sendUploadForm();
   void handleFileUpload();
+  void handleUploadStatus();
   void sendOK();
 
 #ifdef DEBUG
@@ -108,7 +129,7 @@ private:
   void handleDebug();
 #endif
 
-	void extractColor(char argName[], palette_entry& result);
+	void extractColor(const char argName[], palette_entry& result);
 };
 
 extern WebServerClass iWebServer;
@@ -34,9 +34,11 @@
 #include <vector>
 
 #include "config.h"
-#include "matrixobject.h"
 #include "starobject.h"
 #include "particle.h"
+#include "effects.h"
+#include "animationplayer.h"
+#include "scrolltext.h"
 
 typedef struct _leds_template_t
 {
@@ -44,22 +46,48 @@ typedef struct _leds_template_t
 	const std::vector<int> LEDs;
 } leds_template_t;
 
-typedef struct _xy_t
+// header of the calibration file, followed by count calibration_entry records in
+// the order of the LED strip
+typedef struct _calibration_header
 {
-	int xTarget, yTarget, x, y, delay, speed, counter;
-} xy_t;
+	uint32_t magic;
+	uint16_t count;                 // must be NUM_PIXELS
+	uint16_t reserved;
+	uint32_t crc;                   // CRC-32 of the entries
+} calibration_header;
 
-#define NUM_MATRIX_OBJECTS 25
-#define NUM_STARS 10
+// color correction of one LED: value * gain / 128 + offset, black stays black
+typedef struct _calibration_entry
+{
+	uint8_t gain[3];                // R, G, B, 128 = 1.0
+	int8_t offset[3];               // R, G, B, added to values > 0
+} calibration_entry;
+
+// calibration of one channel premultiplied with the current brightness
+typedef struct _calibration_channel
+{
+	uint16_t scale;
+	int16_t offset;
+} calibration_channel;
+
+#define MATRIXMINSPEED 8   // drop speed in 1/256 rows per frame at animspeed 50
+#define MATRIXMAXSPEED 48
+#define MATRIXFADE 19      // trail decay per frame in 1/256 at animspeed 50
 #define NUM_BRIGHTNESS_CURVES 2
 #define DEFAULTICKTIME 20
+#define CALIBRATIONFILE "/calibration.bin"
+#define CALIBRATIONMAGIC 0x4C414357 // "WCAL"
 
 #define FADEINTERVAL 15
 #define RENDERHEARTINTERVAL 10
 #define MATRIXINTERVAL 10
+#define PLASMAINTERVAL 10
 #define FLYINGLETTERSINTERVAL 10
+#define FLYINGLETTERSSPEED 200 // 1/1000 steps per frame
 #define EXPLODEINTERVAL 15
-#define FIREINTERVAL 100
+#define FIREINTERVAL 33
+#define FRAME_PALETTE_SIZE 16 // larger palettes must be static, they are not copied
+#define TEXTSIZE 64           // maximum length of a notification, see showText()
 
 class LEDFunctionsClass
 {
@@ -70,30 +98,31 @@ public:
 	void process();
 	void setBrightness(int brightness);
 	void setMode(DisplayMode newMode);
+	void commit();
+	void materialize();
 	void show();
+	bool loadCalibration();
+	void clearCalibration();
+	bool isCalibrated() { return this->calibration != nullptr; }
+	void showText(const char *text, palette_entry color, int repeat);
+	bool isShowingText();
+	void reloadAnimation();
+
+	// effect registry, see effects.cpp
+	static const effect_descriptor effects[NUM_EFFECTS];
+	static const effect_descriptor *effect(DisplayMode mode);
+	static const effect_descriptor *effectByName(const char *name);
+	static const effect_descriptor *effectByWebId(int webId);
 
 	static int getOffset(int x, int y);
 	static const int width = 11;
 	static const int height = 10;
-	uint8_t currentValues[NUM_PIXELS * 3];
+	uint8_t __attribute__((aligned(4))) currentValues[NUM_PIXELS * 3];
   float AlarmProgress=0; // let the alarm know how much % of the time has passed
 
   // Effect vars
   unsigned long lastUpdate=0; // for some effects
   int lastOffset=0; // for some effects
-  int X1 = 0;
-  int X2 = 10;
-  int Y1 = 0;
-  int Y2 = 9;
-  
-  // Merry Christmas effect vars
-	uint8_t merryChristmasColors[20] = {0};
-  bool merryChristmasColorsInitialized = false;
-  
-  // Happy New Year effect vars
-	uint8_t happyNewYearColors[14] = {0};
-	bool happyNewYearColorsInitialized = false;
-  int happyNewYearState = 0;  // 0 = fireworks, 1 = text
 
 #ifdef FASTLED
   CRGB leds[NUM_PIXELS]; // FastLed
@@ -116,63 +145,112 @@ private:
 	static const std::vector<leds_template_t> minutesTemplate;
 	static const palette_entry firePalette[];
 	static const palette_entry plasmaPalette[];
-  int hourglassState = 0;
 
 	DisplayMode mode = DisplayMode::plain;
+	effect_state *state = nullptr; // state of the active effect, see effects.h
 
 	std::vector<Particle*> particles;
-	std::vector<xy_t> arrivingLetters;
-	std::vector<xy_t> leavingLetters;
-	std::vector<MatrixObject> matrix;
-	std::vector<StarObject> stars;
-	uint8_t targetValues[NUM_PIXELS * 3];
+	uint8_t __attribute__((aligned(4))) targetValues[NUM_PIXELS * 3];
+	uint8_t __attribute__((aligned(4))) frontValues[NUM_PIXELS * 3] = {0}; // last complete frame, read by show()
+	uint8_t ditherError[NUM_PIXELS * 3] = {0}; // fraction lost by the brightness scaling
+
+	// last frame of the previous mode, only allocated while a transition runs
+	uint8_t *transitionFrom = nullptr;
+	unsigned long transitionStart = 0;
+
+	// per LED color calibration, only allocated while a calibration is loaded
+	calibration_entry *calibration = nullptr;
+	calibration_channel *calibrationChannels = nullptr;
+
+	// indexed frame, valid instead of targetValues/currentValues if indexed is true
+	uint8_t __attribute__((aligned(4))) indexValues[NUM_PIXELS_ALIGNED];
+	palette_entry framePalette[FRAME_PALETTE_SIZE];
+	const palette_entry *indexPalette = framePalette;
+	bool indexed = false;
+	bool allowIndexed = false;
+
+	// notification shown by DisplayMode::scrollText
+	char text[TEXTSIZE] = "";
+	palette_entry textColor;
+	int textRepeat = 0;             // passes left
+	uint16_t textSerial = 0;        // incremented for each notification
+	uint16_t animationSerial = 0;   // incremented when the animation file is replaced
 
   
-	int heartBrightness = 0;
-	int heartState = 0;
 	int brightness = 96;
 	int lastM = -1;
 	int lastH = -1;
   unsigned long lastFadeTick=0;
+  unsigned long fadeStart=0;
+  uint32_t fadeEased=65536; // eased progress of the running fade, 65536 = done
 
 
   void drawDot(uint8_t *target, uint8_t x, uint8_t y, palette_entry palette);
   void drawLine(uint8_t *target, int8_t x1, int8_t y1, int8_t x2, int8_t y2, palette_entry color);
 	void fillBackground(int seconds, int milliseconds, uint8_t *buf);
   void fillTime(int h, int m, uint8_t *target);
+	void renderPlain();
+	void renderFade();
 	void renderRed();
 	void renderGreen();
 	void renderBlue();
 	void renderMatrix();
 	void renderHeart();
+	void initFire();
 	void renderFire();
 	void renderPlasma();
+  void initStars();
   void renderStars();
   void renderChristmasTree();
 	void renderJingleBells();
+  void initText();
+  void renderText();
+  void teardownText();
+  unsigned int scrollDelay();
   void renderMerryChristmas();
   void renderHappyNewYear();
-  palette_entry blendedColor(palette_entry from_color, palette_entry to_color, float progress);
+  void teardownHappyNewYear();
+  void initAnimation();
+  void renderAnimation();
+  void teardownAnimation();
+  void playAnimation();
+  static void randomLetterColors(uint8_t *colors, int count);
+  palette_entry blendedColor(palette_entry from_color, palette_entry to_color, uint32_t weight);
   void renderWakeup();
-  void renderRandom(uint8_t *target);
+  void renderRandom();
 	void renderUpdate();
 	void renderUpdateComplete();
 	void renderUpdateError();
-	void renderHourglass(bool green);
+	void initHourglass();
 	void renderWifiManager();
 	void renderTime(uint8_t *target);
+	void initFlyingLetters();
 	void renderFlyingLetters();
 	void prepareFlyingLetters(uint8_t *source);
+	int moveFlyingLetters(flying_letter *letters, int count, uint8_t *buf);
+  void initExplosion();
   void renderExplosion();
+  void teardownParticles();
   void renderRandomDots();
+  void initRandomStripes();
   void renderRandomStripes();
   void renderRotatingLine();
   void renderStripes(uint8_t *target, bool Horizontal);
+  void renderHorizontalStripes();
+  void renderVerticalStripes();
 	void prepareExplosion(uint8_t *source);
 	void fade();
+	void fadeStepped();
+	void startFade();
+	void startTransition();
+	void stopTransition();
+	void composeTransition();
+	void updateCalibration();
 	void set(const uint8_t *buf, palette_entry palette[]);
 	void set(const uint8_t *buf, palette_entry palette[], bool immediately);
-	void setBuffer(uint8_t *target, const uint8_t *source, palette_entry palette[]);
+	bool setBuffer(uint8_t *target, const uint8_t *source, const palette_entry palette[]);
+	void setIndexed(const uint8_t *buf, const palette_entry palette[]);
+	bool isIndexedMode();
 
 	// this mapping table maps the linear memory buffer structure used throughout the
 	// project to the physical layout of the LEDs
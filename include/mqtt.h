@@ -14,6 +14,10 @@
 #define MODENAME "Mode"
 #define ANIMATIONSPEEDNAME "AnimationSpeed"
 #define DEBUGNAME "Debug"
+#define FIRECOOLINGNAME "FireCooling"
+#define FIRESPARKINGNAME "FireSparking"
+#define FIREWINDNAME "FireWind"
+#define NOTIFICATIONNAME "Notification"
 #define CONNECTTIMEOUT 60000 // only try to connect once a minute
 #define PUBLISHTIMEOUT 3600000 // publish the sensors at least every hour 
 
@@ -51,7 +55,7 @@ private:
   void UpdateMQTTDimmer(const char* uniquename, bool Value, uint8_t brightness);
   void UpdateMQTTColorDimmer(const char* uniquename, palette_entry Color);
   void UpdateMQTTModeSelector(const char* uniquename, DisplayMode mode);
-  void UpdateMQTTNumber(const char* uniquename, uint8_t Mod);
+  void UpdateMQTTNumber(const char* uniquename, int Mod);
   void UpdateMQTTText(const char* uniquename, const char* text);
   void UpdateMQTTSwitch(const char* uniquename, bool Value);
 
@@ -66,6 +70,9 @@ private:
 	palette_entry s;
   DisplayMode mqttDisplayMode;
   uint8_t mqtt_animspeed;
+  uint8_t mqtt_firecooling;
+  uint8_t mqtt_firesparking;
+  int8_t mqtt_firewind;
 
   unsigned long lastconnectcheck;
   unsigned long lastmqttpublication;
@@ -0,0 +1,61 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See network.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _NETWORK_H_
+#define _NETWORK_H_
+
+#include <stdint.h>
+#include <WiFiManager.h>
+
+// type definition for the callback on the first successful connection
+typedef void (*TNetworkCallback)();
+
+#define NETWORK_CONNECT_TIMEOUT (180*1000)  // wait for the stored network before opening the portal
+#define NETWORK_PORTAL_TIMEOUT 300          // seconds, then try the stored network again
+#define NETWORK_RECONNECT_INTERVAL 30000    // retry interval after the connection was lost
+
+class NetworkClass
+{
+public:
+	// public methods
+	NetworkClass();
+	void begin(const char *hostname, TNetworkCallback callback);
+	void process();
+	bool connected();
+	bool portalActive();
+
+private:
+	enum class NetworkState
+	{
+		idle, connecting, portal, connected, reconnecting
+	};
+
+	static void configModeCallback(WiFiManager *myWiFiManager);
+	void startPortal();
+	void setState(NetworkState newState);
+
+	WiFiManager wifiManager;
+	NetworkState state = NetworkState::idle;
+	TNetworkCallback _callback = NULL;
+	const char *hostname = NULL;
+	unsigned long stateMillis = 0;
+	bool servicesStarted = false;
+};
+
+extern NetworkClass Network;
+
+#endif
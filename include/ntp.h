@@ -37,6 +37,7 @@ public:
 	void setServer(IPAddress address);
 	IPAddress getServer();
 	void setTimeZone(int timeZone);
+  bool restoreTime(int timezone, bool DST);
   void process();
 
 	// public members
@@ -60,9 +61,20 @@ private:
 		idle, startRequest, waitingForReply, waitingForReload
 	};
 
+	// time stored in RTC user memory, survives everything but a power cycle
+	typedef struct _rtc_time
+	{
+		uint32_t magic;
+		uint32_t epoch;             // UTC seconds since 1970
+		uint32_t ms;                // milliseconds within epoch
+		uint32_t crc;
+	} rtc_time;
+
 	int lastSunday(int year, int month, int lastDayInMonth);
 	int dayOfWeek(int y, int m, int d);
 	void decodeTime(long long t);
+	void setTime(unsigned long secsSince1970);
+	void saveTime();
 	bool isDSTactive();
 	void sendPacket();
 	void parse();
@@ -75,6 +87,10 @@ private:
 	int tz = 0;
 	bool useDST = false;
   unsigned long previousMillis = 0;
+  unsigned long epoch = 0;          // UTC time of the last sync (or restore)
+  unsigned long epochMillis = 0;    // millis() at the last sync
+  bool epochValid = false;
+  int lastSavedSecond = -1;
 };
 
 extern NtpClass NTP;
@@ -0,0 +1,30 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See parse.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _PARSE_H_
+#define _PARSE_H_
+
+#include <stdint.h>
+
+bool parseHexColor(const char *s, uint8_t &r, uint8_t &g, uint8_t &b);
+bool parseInt(const char *s, long &result, long min, long max);
+bool parseHex32(const char *s, uint32_t &result);
+bool parseIP(const char *s, uint8_t ip[4]);
+bool parseBool(const char *s, bool &result);
+bool parseTime(const char *s, int &h, int &m);
+
+#endif
@@ -27,7 +27,7 @@
 class Particle
 {
 private:
-	static const float ParticleGradient[MAX_PARTICLE_DISTANCE];
+	static const uint16_t ParticleGradient[MAX_PARTICLE_DISTANCE];
 	float x, y, vx, vy, x0, y0;
 	int delay;
 
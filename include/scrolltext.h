@@ -0,0 +1,49 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See scrolltext.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _SCROLLTEXT_H_
+#define _SCROLLTEXT_H_
+
+#include <stdint.h>
+#include <vector>
+
+#define SCROLLTEXT_HEIGHT 10
+
+// entries of the column stream
+#define SCROLLTEXT_ROWS   0x03FF    // text column: one bit per row, bit 0 = top row
+#define SCROLLTEXT_COLOR  0x3C00    // text column: palette index of the set pixels
+#define SCROLLTEXT_SPRITE 0x8000    // sprite column: lower bits are the sprite column
+
+class ScrollText
+{
+public:
+	void clear();
+	void addText(const char *text, const uint8_t *colors, uint8_t color);
+	void addSprite(const uint8_t *sprite, int width);
+	void addGap(int columns);
+	void rewind();
+	bool step(uint8_t *frame, int width, int height);
+	int length();
+
+private:
+	std::vector<uint16_t> columns;  // precomputed column stream of the message
+	const uint8_t *sprite = nullptr; // PROGMEM, SCROLLTEXT_HEIGHT palette indexes per column
+	int position = 0;               // next column to enter the display
+};
+
+#endif /* _SCROLLTEXT_H_ */
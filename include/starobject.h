@@ -19,25 +19,29 @@
 #ifndef STAROBJECT_H_
 #define STAROBJECT_H_
 
-#include <vector>
 #include <stdint.h>
 
+#define NUM_STARS 20
+
+// One star of the stars screen saver. Stars live in the effect state (see effects.h)
+// and must stay trivially constructible, the state is zeroed by setMode() and each
+// star is placed by randomize() before it is rendered. speed == 0 marks a star that
+// has not been placed yet.
 class StarObject
 {
 public:
-	StarObject();
-	void render(uint8_t *buf, std::vector<StarObject> &allStars);
-	void randomize(std::vector<StarObject> &allStars);
+	void render(uint8_t *buf, uint8_t *blocked);
+	void randomize(uint8_t *blocked);
 
 private:
 	const static int minimumDistanceSquared = 5;
-	int x = -1;
-	int y = -1;
-	int speed = 0;
-	int count = 0;
-	int brightness = 0;
-	int state = 0;
-	void update(std::vector<StarObject> &allStars);
+	int8_t x;
+	int8_t y;
+	uint8_t speed;
+	uint8_t state;
+	int16_t brightness;
+	void update(uint8_t *blocked);
+	void mark(uint8_t *blocked, int delta);
 };
 
 #endif /* STAROBJECT_H_ */
@@ -0,0 +1,122 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  See webbackend.cpp for description.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef _WEBBACKEND_H_
+#define _WEBBACKEND_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+// number of completed requests which may wait for the main loop
+#define WEBBACKEND_QUEUE_SIZE 8
+
+// number of queued requests handled per call to handleClient()
+#define WEBBACKEND_MAX_DISPATCH 1
+
+// maximum size of a request body (e.g. the JSON posted to /saveconfig)
+#define WEBBACKEND_MAX_BODY 2048
+
+// do not include ESPAsyncWebServer.h here, its HTTP method enum collides with the
+// one from ESP8266WebServer.h which is still needed by WiFiManager
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// upload state passed to upload handlers, field names match HTTPUpload so the same
+// handler code works with both backends
+typedef struct
+{
+	int status;
+	String filename;
+	size_t totalSize;
+	size_t currentSize;
+	const uint8_t *buf;
+} WebUpload;
+
+class AsyncWebBackend
+{
+public:
+	typedef std::function<void(void)> THandlerFunction;
+
+	AsyncWebBackend(int port);
+	virtual ~AsyncWebBackend();
+
+	// route registration, method values follow HTTPMethod of ESP8266WebServer
+	void on(const char *uri, THandlerFunction handler);
+	void on(const char *uri, int method, THandlerFunction handler);
+	void on(const char *uri, int method, THandlerFunction handler,
+		THandlerFunction uploadHandler);
+	void onNotFound(THandlerFunction handler);
+	void begin();
+	void handleClient();
+
+	// request accessors, only valid while a handler is running
+	bool hasArg(const char *name);
+	const String& arg(const char *name);
+	const String& arg(int i);
+	const String& argName(int i);
+	int args();
+	const String& uri();
+	int method();
+	WebUpload& upload();
+
+	// responses
+	void send(int code, const String& contentType = String(),
+		const String& content = String());
+	size_t streamFile(File& file, const String& contentType);
+
+private:
+	typedef struct
+	{
+		String uri;
+		int method;
+		THandlerFunction handler;
+		THandlerFunction uploadHandler;
+	} Route;
+
+	int findRoute(AsyncWebServerRequest *request);
+	void enqueue(AsyncWebServerRequest *request);
+	void drop(AsyncWebServerRequest *request);
+	void handleUploadChunk(AsyncWebServerRequest *request, const String& filename,
+		size_t index, uint8_t *data, size_t len, bool final);
+	void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len,
+		size_t index, size_t total);
+
+	AsyncWebServer *server = NULL;
+	std::vector<Route> routes;
+	THandlerFunction notFoundHandler = nullptr;
+
+	// ring buffer of requests whose headers and body are complete
+	AsyncWebServerRequest *queue[WEBBACKEND_QUEUE_SIZE];
+	uint8_t queueHead = 0;
+	uint8_t queueCount = 0;
+
+	// request currently being handled and its cached properties
+	AsyncWebServerRequest *current = NULL;
+	AsyncWebServerRequest *answered = NULL;
+	AsyncWebServerRequest *uploading = NULL;
+	int uploadRoute = -1;
+	bool responded = false;
+	bool inUpload = false;
+	String currentUri;
+	String plainBody;
+	String empty;
+	WebUpload currentUpload;
+};
+
+#endif
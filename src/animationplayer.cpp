@@ -0,0 +1,303 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Plays indexed animations from LittleFS. An animation file (see animation_header)
+//  holds a palette of up to 16 colors and a sequence of frames with their own display
+//  time. Each frame is a list of (count, index) runs over all LEDs, runs with index
+//  ANIMATIONKEEP leave the LEDs of the previous frame unchanged, so a frame only needs
+//  to encode what moved. Frames are decoded while they are read through a small
+//  read-ahead buffer, neither the file nor a frame list is held in RAM. Built-in
+//  animations use the same format from PROGMEM (see hourglass_animation.h).
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <Arduino.h>
+#include "animationplayer.h"
+
+//---------------------------------------------------------------------------------------
+// ~AnimationPlayer
+//
+// Destructor, closes the file
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+AnimationPlayer::~AnimationPlayer()
+{
+	this->close();
+}
+
+//---------------------------------------------------------------------------------------
+// open
+//
+// Opens an animation file and reads its header and palette. A previously opened
+// animation is closed first. The path is kept even if the file is invalid, so
+// isPath() can tell whether it was already tried.
+//
+// -> path: file name on LittleFS
+// <- true if the file is a valid animation
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::open(const char *path)
+{
+	this->close();
+	strncpy(this->path, path, ANIMATIONPATHSIZE);
+	this->path[ANIMATIONPATHSIZE - 1] = 0;
+
+	this->file = LittleFS.open(path, "r");
+	if (!this->file) return false;
+	return this->start();
+}
+
+//---------------------------------------------------------------------------------------
+// open
+//
+// Opens a built-in animation stored in PROGMEM, same format as an animation file
+//
+// -> data: animation in PROGMEM
+//    size: size of data in bytes
+// <- true if data is a valid animation
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::open(const uint8_t *data, uint32_t size)
+{
+	this->close();
+	this->path[0] = 0;
+	this->data = data;
+	this->dataSize = size;
+	return this->start();
+}
+
+//---------------------------------------------------------------------------------------
+// start
+//
+// Reads header and palette of the opened animation and continues with the first frame
+//
+// -> --
+// <- true if the animation is valid, it is closed otherwise
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::start()
+{
+	this->dataPos = 0;
+	this->bufferPos = 0;
+	this->bufferFill = 0;
+
+	bool ok = this->readBytes((uint8_t*)&this->header, sizeof(this->header)) &&
+		this->header.magic == ANIMATIONMAGIC &&
+		this->header.frameCount > 0 &&
+		this->header.colors > 0 && this->header.colors <= ANIMATIONMAXCOLORS &&
+		this->readBytes((uint8_t*)this->palette, this->header.colors * sizeof(palette_entry));
+	if (!ok)
+	{
+		Serial.printf("AnimationPlayer: %s is not a valid animation\r\n", this->name());
+		this->close();
+		return false;
+	}
+
+	this->valid = true;
+	this->firstFrame = sizeof(this->header) + this->header.colors * sizeof(palette_entry);
+	this->rewind();
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// close
+//
+// Closes the animation
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void AnimationPlayer::close()
+{
+	if (this->file) this->file.close();
+	this->data = nullptr;
+	this->valid = false;
+}
+
+//---------------------------------------------------------------------------------------
+// isOpen
+//
+// -> --
+// <- true if an animation is open
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::isOpen()
+{
+	return this->valid;
+}
+
+//---------------------------------------------------------------------------------------
+// fades
+//
+// Checks if the open animation fades to its frames (ANIMATION_FADE)
+//
+// -> --
+// <- true if an animation is open and fades
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::fades()
+{
+	return this->valid && (this->header.flags & ANIMATION_FADE);
+}
+
+//---------------------------------------------------------------------------------------
+// isPath
+//
+// Checks if the given file was the last one passed to open()
+//
+// -> path: file name on LittleFS
+// <- true if path was opened last, even if it is not a valid animation
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::isPath(const char *path)
+{
+	return strncmp(this->path, path, ANIMATIONPATHSIZE - 1) == 0;
+}
+
+//---------------------------------------------------------------------------------------
+// rewind
+//
+// Continues with the first frame
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void AnimationPlayer::rewind()
+{
+	if (this->data != nullptr) this->dataPos = this->firstFrame;
+	else this->file.seek(this->firstFrame);
+	this->frameIndex = 0;
+	this->bufferPos = 0;
+	this->bufferFill = 0;
+}
+
+//---------------------------------------------------------------------------------------
+// readByte
+//
+// Reads the next byte from PROGMEM or through the read-ahead buffer from the file
+//
+// -> --
+// <- next byte, -1 at the end of the animation
+//---------------------------------------------------------------------------------------
+int AnimationPlayer::readByte()
+{
+	if (this->data != nullptr)
+	{
+		if (this->dataPos >= this->dataSize) return -1;
+		return pgm_read_byte(this->data + this->dataPos++);
+	}
+	if (this->bufferPos >= this->bufferFill)
+	{
+		this->bufferFill = this->file.read(this->buffer, ANIMATIONREADAHEAD);
+		this->bufferPos = 0;
+		if (this->bufferFill == 0) return -1;
+	}
+	return this->buffer[this->bufferPos++];
+}
+
+//---------------------------------------------------------------------------------------
+// readBytes
+//
+// Reads a block of bytes, see readByte()
+//
+// -> target: receives the data
+//    count: number of bytes
+// <- false if the animation ends before count bytes were read
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::readBytes(uint8_t *target, int count)
+{
+	while (count-- > 0)
+	{
+		int b = this->readByte();
+		if (b < 0) return false;
+		*target++ = b;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// name
+//
+// -> --
+// <- file name of the animation for log messages
+//---------------------------------------------------------------------------------------
+const char *AnimationPlayer::name()
+{
+	return this->data != nullptr ? "built-in animation" : this->path;
+}
+
+//---------------------------------------------------------------------------------------
+// decodeFrame
+//
+// Reads the next frame and decodes it on top of the previous one
+//
+// -> frame: indexed frame holding the previous frame
+//    duration: receives the display time of the frame in ms
+// <- false if the frame is damaged
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::decodeFrame(uint8_t *frame, uint16_t &duration)
+{
+	animation_frame frameHeader;
+	if (!this->readBytes((uint8_t*)&frameHeader, sizeof(frameHeader))) return false;
+	if (frameHeader.length & 1) return false;
+
+	int pixel = 0;
+	for (int i = 0; i < frameHeader.length; i += 2)
+	{
+		int count = this->readByte();
+		int index = this->readByte();
+		if (index < 0 || pixel + count > NUM_PIXELS) return false;
+		if (index != ANIMATIONKEEP)
+		{
+			if (index >= this->header.colors) return false;
+			memset(frame + pixel, index, count);
+		}
+		pixel += count;
+	}
+
+	duration = frameHeader.duration;
+	return pixel == NUM_PIXELS;
+}
+
+//---------------------------------------------------------------------------------------
+// nextFrame
+//
+// Decodes the next frame on top of the previous one. After the last frame the
+// animation starts over if ANIMATION_LOOP is set, otherwise the last frame is kept.
+// The first frame should not use ANIMATIONKEEP, it is decoded on top of the last one
+// when the animation loops.
+//
+// -> frame: indexed frame (NUM_PIXELS_ALIGNED bytes) holding the previous frame
+//    duration: receives the display time of the frame in ms
+// <- false if the file is damaged, the animation is closed then
+//---------------------------------------------------------------------------------------
+bool AnimationPlayer::nextFrame(uint8_t *frame, uint16_t &duration)
+{
+	if (!this->isOpen()) return false;
+
+	if (this->frameIndex >= this->header.frameCount)
+	{
+		if (!(this->header.flags & ANIMATION_LOOP))
+		{
+			duration = 1000;
+			return true;
+		}
+		this->rewind();
+	}
+
+	if (!this->decodeFrame(frame, duration))
+	{
+		Serial.printf("AnimationPlayer: frame %i of %s is damaged\r\n", this->frameIndex, this->name());
+		this->close();
+		return false;
+	}
+	this->frameIndex++;
+	return true;
+}
@@ -2,12 +2,29 @@
 // Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
 //
 //  This is the configuration module. It contains methods to load/save the
-//  configuration from/to the internal EEPROM (simulated EEPROM in flash).
-//  Data is loaded into this->eeprom_data[EEPROM_SIZE] which shares RAM with
-//  this->config. Configuration variables are copied to public class members
-//  ntpserver, heartbeat, ... where they can be used by other modules. Upon
-//  save, the public members are copied back to this->config/this->eeprom_data[]
-//  and then written to the EEPROM.
+//  configuration from/to a binary record file on LittleFS. The record consists of a
+//  header (magic, version, payload length, CRC-32) and the config_struct payload.
+//  Data is loaded into this->config. Configuration variables are copied to public
+//  class members ntpserver, heartbeat, ... where they can be used by other modules.
+//  Upon save, the public members are copied back to this->config and the record is
+//  rewritten if anything changed. A new record is written to a temporary file and
+//  renamed, so an interrupted save leaves the previous record intact; LittleFS
+//  spreads the writes over the whole file system instead of one EEPROM sector.
+//
+//  Small changes (alarm deactivation, night mode, brightness, ...) are not written as
+//  a new record but appended to a journal file as entries of the changed bytes, each
+//  protected by a checksum. On load the journal is replayed on top of the record up
+//  to the first incomplete entry. When the journal is full it is compacted: a new
+//  record containing all changes is written and the journal is deleted. The journal
+//  header holds the CRC of the record it belongs to, so a journal left over from an
+//  interrupted compaction is ignored.
+//  The journal saves writing the whole record and the rename, but not the erase: after
+//  the file is reopened, LittleFS copies its last block to a freshly erased block on
+//  every append. A save therefore still costs about one block erase, which LittleFS
+//  levels over the file system like any other write.
+//
+//  Configurations stored by older versions in the (simulated) EEPROM are migrated
+//  to the record file on first boot.
 //
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -26,6 +43,12 @@
 #include <LittleFS.h>               // Filesystem
 #include "config.h"
 #include "brightness.h"
+#include "ledfunctions.h"
+#include "crc32.h"
+
+// length of the config stored in the EEPROM by older firmware versions
+#define EEPROMCONFIGLENGTH offsetof(config_struct, fadeDuration)
+static_assert(EEPROMCONFIGLENGTH <= EEPROM_SIZE, "EEPROM config does not fit");
 
 
 //---------------------------------------------------------------------------------------
@@ -61,14 +84,13 @@ ConfigClass::~ConfigClass()
 //---------------------------------------------------------------------------------------
 // begin
 //
-// Initializes the class and loads current configuration from EEPROM into class members.
+// Initializes the class and loads current configuration into class members.
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
 void ConfigClass::begin()
 {
-  EEPROM.begin(EEPROM_SIZE);
   LittleFS.begin();
 	this->load();
   this->lastMillis=millis();
@@ -77,8 +99,7 @@ void ConfigClass::begin()
 //---------------------------------------------------------------------------------------
 // saveDelayed
 //
-// Copies the current class member values to EEPROM buffer and writes it to the EEPROM
-// after 10 seconds.
+// Schedules a save() after 10 seconds, so a series of changes results in one write.
 //
 // -> --
 // <- --
@@ -98,7 +119,7 @@ void ConfigClass::saveDelayed()
 //---------------------------------------------------------------------------------------
 void ConfigClass::process()
 {
-  // decrement delayed EEPROM config timer
+  // decrement delayed config write timer
   if(this->delayedWriteTimer>0)
   {
     this->delayedWriteTimer-=(unsigned long)(millis() - this->lastMillis);
@@ -139,52 +160,9 @@ JsonDocument ConfigClass::json()
   // Create json object
   JsonDocument json;
 
-  int displaymode = 0;
-  switch(Config.defaultMode)
-  {
-  case DisplayMode::plain:
-    displaymode = 0; break;
-  case DisplayMode::fade:
-    displaymode = 1; break;
-  case DisplayMode::flyingLettersVerticalUp:
-    displaymode = 2; break;
-  case DisplayMode::flyingLettersVerticalDown:
-    displaymode = 3; break;
-  case DisplayMode::explode:
-    displaymode = 4; break;
-  case DisplayMode::wakeup:
-    displaymode = 5; break;
-  case DisplayMode::matrix:
-    displaymode = 6; break;
-  case DisplayMode::heart:
-    displaymode = 7; break;
-  case DisplayMode::fire:
-    displaymode = 8; break;
-  case DisplayMode::stars:
-    displaymode = 9; break;
-  case DisplayMode::random:
-    displaymode = 10; break;
-  case DisplayMode::HorizontalStripes:
-    displaymode = 11; break;
-  case DisplayMode::VerticalStripes:
-    displaymode = 12; break;
-  case DisplayMode::RandomDots:
-    displaymode = 13; break;
-  case DisplayMode::RandomStripes:
-    displaymode = 14; break;
-  case DisplayMode::RotatingLine:
-    displaymode = 15; break;
-  case DisplayMode::christmastree:
-    displaymode = 16; break;
-  case DisplayMode::jinglebells:
-    displaymode = 17; break;
-  case DisplayMode::merryChristmas:
-    displaymode = 18; break;
-  case DisplayMode::happyNewYear:
-    displaymode = 19; break;
-  default:
-    displaymode = 1; break;
-  }
+  // index in the mode list of the web page, fade if the mode is not in the list
+  const effect_descriptor *effect = LEDFunctionsClass::effect(Config.defaultMode);
+  int displaymode = (effect != NULL && effect->webId >= 0) ? effect->webId : 1;
  
   JsonObject background = json["backgroundcolor"].to<JsonObject>();
   background["r"] = Config.bg.r;
@@ -218,23 +196,11 @@ JsonDocument ConfigClass::json()
   for (int i=0;i<5;i++) {
     String alarmmode,alarmtype;
   
-    switch(Config.alarm[i].mode)
-    {
-    case DisplayMode::matrix:
-      alarmmode = "matrix"; break;
-    case DisplayMode::plasma:
-      alarmmode = "plasma"; break;
-    case DisplayMode::fire:
-      alarmmode  = "fire"; break;
-    case DisplayMode::heart:
-      alarmmode = "heart"; break;
-    case DisplayMode::stars:
-      alarmmode = "stars"; break;
-    case DisplayMode::wakeup:
-      alarmmode = "wakeup"; break;
-    default:
-      alarmmode = "unknown"; break;
-    }
+    const effect_descriptor *alarmeffect = LEDFunctionsClass::effect(Config.alarm[i].mode);
+    if (alarmeffect != NULL && (alarmeffect->flags & EFFECT_ALARM))
+      alarmmode = alarmeffect->name;
+    else
+      alarmmode = "unknown";
 
     switch(Config.alarm[i].type)
     {
@@ -271,6 +237,18 @@ JsonDocument ConfigClass::json()
   json["usemqttauthentication"] = Config.usemqttauthentication;
   json["mqttuser"] = Config.mqttuser;
   json["mqttpass"] = Config.mqttpass; 
+
+  // fading
+  json["fadeduration"] = Config.fadeDuration;
+  json["fadeeasing"] = fadeEasingName(Config.fadeEasing);
+  json["dithering"] = Config.dithering;
+  json["matrixdensity"] = Config.matrixDensity;
+  json["firecooling"] = Config.fireCooling;
+  json["firesparking"] = Config.fireSparking;
+  json["firewind"] = Config.fireWind;
+  json["transition"] = transitionName(Config.transition);
+  json["transitionduration"] = Config.transitionDuration;
+  json["animation"] = Config.animationFile;
  
   return json;
 }
@@ -278,7 +256,8 @@ JsonDocument ConfigClass::json()
 //---------------------------------------------------------------------------------------
 // save
 //
-// Copies the current class member values to EEPROM buffer and writes it to the EEPROM.
+// Copies the current class member values to the config record and writes it to flash
+// if anything has changed.
 //
 // -> --
 // <- --
@@ -287,6 +266,191 @@ void ConfigClass::save()
 {
   this->delayedWriteTimer = 0; // Make sure we are not saving again after timer expires
 
+  config_struct previous = *this->config;
+  this->store();
+
+  if (!LittleFS.exists(CONFIGRECORDFILE))
+  {
+    this->compact();
+    return;
+  }
+
+  if (memcmp(&previous, this->config, sizeof(config_struct)) == 0)
+  {
+    if (this->logLevel >= LOG_INFO) Serial.println(F("Config unchanged, not writing"));
+    return;
+  }
+
+  if (this->appendJournal(previous))
+  {
+    if (this->logLevel >= LOG_INFO) Serial.printf("Config changes journaled (%u bytes)\n", this->journalSize);
+  }
+  else
+    this->compact();
+}
+
+//---------------------------------------------------------------------------------------
+// compact
+//
+// Writes the complete config as a new record and deletes the journal.
+//
+// -> --
+// <- true if the record was written
+//---------------------------------------------------------------------------------------
+bool ConfigClass::compact()
+{
+  if (this->writeRecord())
+  {
+    LittleFS.remove(CONFIGJOURNALFILE);
+    this->journalSize = 0;
+    if (this->logLevel >= LOG_INFO) Serial.println(F("Config saved"));
+    return true;
+  }
+
+  Serial.println(F("Unable to save config"));
+  return false;
+}
+
+//---------------------------------------------------------------------------------------
+// entryCheck
+//
+// Calculates the check value of a journal entry
+//
+// -> entry: entry header (check is ignored)
+//    data: entry.length bytes of data
+// <- check value
+//---------------------------------------------------------------------------------------
+uint16_t ConfigClass::entryCheck(const journal_entry &entry, const uint8_t *data)
+{
+  uint32_t crc = crc32Update(CRC32_INIT, &entry.offset, sizeof(entry.offset));
+  crc = crc32Update(crc, &entry.length, sizeof(entry.length));
+  crc = crc32Update(crc, data, entry.length);
+  return (uint16_t)(crc ^ CRC32_INIT);
+}
+
+//---------------------------------------------------------------------------------------
+// appendJournal
+//
+// Appends an entry for every changed range of this->config to the journal. Ranges
+// separated by only a few unchanged bytes are merged, as a separate entry would cost
+// more than rewriting those bytes. Note that the append still makes LittleFS erase
+// and rewrite the last block of the journal file.
+//
+// -> previous: config as it was before the change
+// <- false if the journal is full (or could not be written), compact() is required
+//---------------------------------------------------------------------------------------
+bool ConfigClass::appendJournal(const config_struct &previous)
+{
+  const uint8_t *oldData = (const uint8_t*)&previous;
+  const uint8_t *newData = (const uint8_t*)this->config;
+  const uint16_t size = sizeof(config_struct);
+  journal_entry entries[8];
+  int count = 0;
+  uint32_t needed = this->journalSize == 0 ? sizeof(journal_header) : 0;
+
+  // collect changed ranges
+  for (uint16_t i = 0; i < size; i++)
+  {
+    if (oldData[i] == newData[i]) continue;
+    if (count > 0 && i - (entries[count-1].offset + entries[count-1].length) <= (int)sizeof(journal_entry))
+    {
+      entries[count-1].length = i + 1 - entries[count-1].offset;
+      continue;
+    }
+    if (count == sizeof(entries)/sizeof(entries[0])) return false;
+    entries[count].offset = i;
+    entries[count].length = 1;
+    count++;
+  }
+  for (int i = 0; i < count; i++)
+    needed += sizeof(journal_entry) + entries[i].length;
+  if (this->journalSize + needed > CONFIGJOURNALSIZE) return false;
+
+  File f = LittleFS.open(CONFIGJOURNALFILE, this->journalSize == 0 ? "w" : "a");
+  if (!f) return false;
+
+  bool ok = true;
+  if (this->journalSize == 0)
+  {
+    journal_header header = { CONFIGJOURNALMAGIC, this->recordCrc };
+    ok = f.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+  }
+  for (int i = 0; ok && i < count; i++)
+  {
+    entries[i].check = this->entryCheck(entries[i], newData + entries[i].offset);
+    ok = f.write((const uint8_t*)&entries[i], sizeof(journal_entry)) == sizeof(journal_entry) &&
+      f.write(newData + entries[i].offset, entries[i].length) == entries[i].length;
+  }
+  f.close();
+  if (!ok) return false;
+
+  this->journalSize += needed;
+  return true;
+}
+
+//---------------------------------------------------------------------------------------
+// replayJournal
+//
+// Applies the journal entries to this->config. Stops at the first incomplete or
+// corrupted entry, which can only be the last one written before a power loss.
+//
+// -> --
+// <- false if the journal contained an invalid entry and must be compacted
+//---------------------------------------------------------------------------------------
+bool ConfigClass::replayJournal()
+{
+  journal_header header;
+  journal_entry entry;
+  uint8_t data[sizeof(config_struct)];
+  bool ok = true;
+
+  this->journalSize = 0;
+  File f = LittleFS.open(CONFIGJOURNALFILE, "r");
+  if (!f) return true;
+
+  if (f.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != CONFIGJOURNALMAGIC || header.recordCrc != this->recordCrc)
+  {
+    // no journal for the current record
+    f.close();
+    LittleFS.remove(CONFIGJOURNALFILE);
+    return true;
+  }
+
+  uint32_t position = sizeof(header);
+  int count = 0;
+  while (f.available())
+  {
+    if (f.read((uint8_t*)&entry, sizeof(entry)) != sizeof(entry) ||
+        (size_t)entry.offset + entry.length > sizeof(config_struct) ||
+        f.read(data, entry.length) != entry.length ||
+        this->entryCheck(entry, data) != entry.check)
+    {
+      Serial.println(F("Config journal: incomplete entry"));
+      ok = false;
+      break;
+    }
+    memcpy((uint8_t*)this->config + entry.offset, data, entry.length);
+    position += sizeof(entry) + entry.length;
+    count++;
+  }
+  f.close();
+
+  this->journalSize = position;
+  if (this->logLevel >= LOG_INFO) Serial.printf("Config journal: %d entries, %u bytes\n", count, position);
+  return ok;
+}
+
+//---------------------------------------------------------------------------------------
+// store
+//
+// Copies the current class member values to this->config.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void ConfigClass::store()
+{
 	this->config->bg = this->bg;
 	this->config->fg = this->fg;
 	this->config->s = this->s;
@@ -312,20 +476,129 @@ void ConfigClass::save()
   strncpy(this->config->mqttuser,this->mqttuser,CONFIGSTRINGSIZE);
   strncpy(this->config->mqttpass,this->mqttpass,CONFIGSTRINGSIZE);
 
-	for (int i = 0; i < EEPROM_SIZE; i++)
-		EEPROM.write(i, this->eeprom_data[i]);
-	EEPROM.commit();
-
-  // save the new file
-  File configFile = LittleFS.open(CONFIGFILE, "w");
-  if (!configFile) {
-    Serial.println(F("unable to open ")+String(CONFIGFILE));
-  } else {
-    // Save the file
-    serializeJson(this->json(), configFile);
-    configFile.close();
-    Serial.println(F("Configfile saved"));
-  }  
+  // fading
+  this->config->fadeDuration = this->fadeDuration;
+  this->config->fadeEasing = (uint8_t) this->fadeEasing;
+  this->config->dithering = this->dithering;
+  this->config->matrixDensity = this->matrixDensity;
+  this->config->fireCooling = this->fireCooling;
+  this->config->fireSparking = this->fireSparking;
+  this->config->fireWind = this->fireWind;
+  strncpy(this->config->animationFile, this->animationFile, CONFIGSTRINGSIZE);
+  this->config->transition = (uint8_t) this->transition;
+  this->config->transitionDuration = this->transitionDuration;
+}
+
+//---------------------------------------------------------------------------------------
+// writeRecord
+//
+// Writes this->config as a new config record. The record is written to a temporary
+// file which then replaces the previous record.
+//
+// -> --
+// <- true if successful
+//---------------------------------------------------------------------------------------
+bool ConfigClass::writeRecord()
+{
+  config_header header;
+  header.magic = CONFIGRECORDMAGIC;
+  header.version = CONFIGVERSION;
+  header.length = sizeof(config_struct);
+  header.crc = crc32Update(CRC32_INIT, this->config, sizeof(config_struct)) ^ CRC32_INIT;
+  this->recordCrc = header.crc;
+
+  File f = LittleFS.open(CONFIGTEMPFILE, "w");
+  if (!f) return false;
+  bool ok = f.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+    f.write((const uint8_t*)this->config, sizeof(config_struct)) == sizeof(config_struct);
+  f.close();
+
+  if (!ok || !LittleFS.rename(CONFIGTEMPFILE, CONFIGRECORDFILE))
+  {
+    LittleFS.remove(CONFIGTEMPFILE);
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------------------
+// readRecord
+//
+// Reads the config record into this->config. Records of older versions are shorter,
+// fields missing in them keep the values already present in this->config. Such a
+// record is only migrated in memory, the caller has to write it after replaying the
+// journal (which still belongs to the record on flash).
+//
+// -> migrate: set to true if the record has an older version
+// <- true if a valid record was found
+//---------------------------------------------------------------------------------------
+bool ConfigClass::readRecord(bool &migrate)
+{
+  config_header header;
+  config_struct record = *this->config;
+
+  File f = LittleFS.open(CONFIGRECORDFILE, "r");
+  if (!f) return false;
+
+  bool ok = f.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+    header.magic == CONFIGRECORDMAGIC &&
+    header.version <= CONFIGVERSION &&
+    header.length <= sizeof(config_struct) &&
+    f.read((uint8_t*)&record, header.length) == header.length &&
+    (crc32Update(CRC32_INIT, &record, header.length) ^ CRC32_INIT) == header.crc;
+  f.close();
+  if (!ok) return false;
+
+  *this->config = record;
+  this->recordCrc = header.crc;
+  migrate = header.version != CONFIGVERSION || header.length != sizeof(config_struct);
+  if (migrate)
+    Serial.printf("Migrating config record from version %u to %u\n", header.version, CONFIGVERSION);
+  return true;
+}
+
+//---------------------------------------------------------------------------------------
+// migrateEEPROM
+//
+// Reads a config stored in the EEPROM by older firmware versions into this->config.
+// The EEPROM layout ends before fadeDuration, the fields added since then keep the
+// defaults already present in this->config.
+//
+// -> --
+// <- true if a valid EEPROM config was found
+//---------------------------------------------------------------------------------------
+bool ConfigClass::migrateEEPROM()
+{
+  config_struct record = *this->config;
+
+  EEPROM.begin(EEPROM_SIZE);
+  for (unsigned int i = 0; i < EEPROMCONFIGLENGTH; i++)
+    ((uint8_t*)&record)[i] = EEPROM.read(i);
+  EEPROM.end();
+
+  if (record.magic != 0xDEADBEEF) return false;
+
+  Serial.println(F("Migrating EEPROM config to config record"));
+  *this->config = record;
+  return true;
+}
+
+//---------------------------------------------------------------------------------------
+// clearEEPROM
+//
+// Invalidates the legacy EEPROM config once it has been migrated, so a lost or
+// damaged config record later falls back to the defaults instead of the old settings
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void ConfigClass::clearEEPROM()
+{
+  EEPROM.begin(EEPROM_SIZE);
+  for (unsigned int i = 0; i < sizeof(this->config->magic); i++)
+    EEPROM.write(offsetof(config_struct, magic) + i, 0);
+  EEPROM.commit();
+  EEPROM.end();
 }
 
 //---------------------------------------------------------------------------------------
@@ -398,29 +671,65 @@ void ConfigClass::reset()
   this->usemqttauthentication = false;
   strcpy(this->mqttuser,"");
   strcpy(this->mqttpass,"");
+
+  // fading
+  this->fadeDuration = 900;
+  this->fadeEasing = FadeEasing::easeInOut;
+  this->dithering = false;
+  this->matrixDensity = 50;
+  this->fireCooling = 15;
+  this->fireSparking = 30;
+  this->fireWind = 0;
+  strcpy(this->animationFile, ANIMATIONFILE);
+  this->transition = TransitionType::crossfade;
+  this->transitionDuration = 600;
 }
 
 //---------------------------------------------------------------------------------------
 // load
 //
-// Reads the content of the EEPROM into the EEPROM buffer and copies the values to the
-// public member variables. Resets (and saves) the values to their defaults if the
-// EEPROM data is not initialized.
+// Reads the config record and copies the values to the public member variables.
+// Migrates the EEPROM config of older versions if no record exists, resets (and
+// saves) the values to their defaults if neither is valid.
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
 void ConfigClass::load()
 {
-	Serial.println(F("Reading EEPROM config"));
-	for (int i = 0; i < EEPROM_SIZE; i++)
-		this->eeprom_data[i] = EEPROM.read(i);
-	if (this->config->magic != 0xDEADBEEF)
-	{
-		Serial.println(F("EEPROM config invalid, writing default values"));
-		this->reset();
-		this->save();
-	}
+	Serial.println(F("Reading config"));
+
+  // start with the defaults, they remain for fields missing in older records
+  this->reset();
+  this->store();
+
+  bool migrate = false;
+  if (this->readRecord(migrate))
+  {
+    // the journal has to be replayed before a migrated record replaces the old one
+    if (!this->replayJournal() || migrate)
+      this->compact();
+  }
+  else
+  {
+    if (this->migrateEEPROM())
+    {
+      // the old copies are only dropped once the record holds the migrated config
+      if (this->compact())
+      {
+        LittleFS.remove(CONFIGFILE);
+        this->clearEEPROM();
+      }
+    }
+    else
+    {
+      Serial.println(F("Config invalid, writing default values"));
+      this->reset();
+      this->store();
+      this->compact();
+    }
+  }
+
 	this->bg = this->config->bg;
 	this->fg = this->config->fg;
 	this->s = this->config->s;
@@ -450,4 +759,103 @@ void ConfigClass::load()
   this->mqttuser[CONFIGSTRINGSIZE-1]='\0';// prevent crash by forcing 0 termination
   strncpy(this->mqttpass,this->config->mqttpass,CONFIGSTRINGSIZE);
   this->mqttpass[CONFIGSTRINGSIZE-1]='\0'; // prevent crash by forcing 0 termination
+
+  // fading
+  this->fadeDuration = constrain(this->config->fadeDuration, FADEDURATION_MIN, FADEDURATION_MAX);
+  this->fadeEasing = this->config->fadeEasing < (uint8_t) FadeEasing::invalid ?
+    (FadeEasing) this->config->fadeEasing : FadeEasing::easeInOut;
+  this->dithering = this->config->dithering;
+  this->matrixDensity = constrain(this->config->matrixDensity, 1, 100);
+  this->fireCooling = min(this->config->fireCooling, (uint8_t) FIRECOOLING_MAX);
+  this->fireSparking = min(this->config->fireSparking, (uint8_t) FIRESPARKING_MAX);
+  this->fireWind = constrain(this->config->fireWind, -FIREWIND_MAX, FIREWIND_MAX);
+  strncpy(this->animationFile, this->config->animationFile, CONFIGSTRINGSIZE);
+  this->animationFile[CONFIGSTRINGSIZE-1] = '\0'; // prevent crash by forcing 0 termination
+  this->transition = this->config->transition < (uint8_t) TransitionType::invalid ?
+    (TransitionType) this->config->transition : TransitionType::crossfade;
+  this->transitionDuration = constrain(this->config->transitionDuration, TRANSITIONDURATION_MIN, TRANSITIONDURATION_MAX);
+}
+
+//---------------------------------------------------------------------------------------
+// fadeEasingName
+//
+// Converts a fade easing to its name as used in the web interface
+//
+// -> easing: ...
+// <- name
+//---------------------------------------------------------------------------------------
+const char *ConfigClass::fadeEasingName(FadeEasing easing)
+{
+  switch(easing)
+  {
+  case FadeEasing::stepped:
+    return "stepped";
+  case FadeEasing::linear:
+    return "linear";
+  case FadeEasing::gamma:
+    return "gamma";
+  case FadeEasing::easeInOut:
+    return "easeinout";
+  default:
+    return "unknown";
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// fadeEasingFromName
+//
+// Converts a name (case insensitive) back to a fade easing
+//
+// -> name: ...
+// <- easing, FadeEasing::invalid if the name is unknown
+//---------------------------------------------------------------------------------------
+FadeEasing ConfigClass::fadeEasingFromName(const char *name)
+{
+  for (int i = 0; i < (int) FadeEasing::invalid; i++)
+  {
+    if (strcasecmp(name, fadeEasingName((FadeEasing) i)) == 0) return (FadeEasing) i;
+  }
+  return FadeEasing::invalid;
+}
+
+//---------------------------------------------------------------------------------------
+// transitionName
+//
+// Converts a transition type to its name as used in the web interface
+//
+// -> transition: ...
+// <- name
+//---------------------------------------------------------------------------------------
+const char *ConfigClass::transitionName(TransitionType transition)
+{
+  switch(transition)
+  {
+  case TransitionType::none:
+    return "none";
+  case TransitionType::crossfade:
+    return "crossfade";
+  case TransitionType::wipe:
+    return "wipe";
+  case TransitionType::dissolve:
+    return "dissolve";
+  default:
+    return "unknown";
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// transitionFromName
+//
+// Converts a name (case insensitive) back to a transition type
+//
+// -> name: ...
+// <- transition type, TransitionType::invalid if the name is unknown
+//---------------------------------------------------------------------------------------
+TransitionType ConfigClass::transitionFromName(const char *name)
+{
+  for (int i = 0; i < (int) TransitionType::invalid; i++)
+  {
+    if (strcasecmp(name, transitionName((TransitionType) i)) == 0) return (TransitionType) i;
+  }
+  return TransitionType::invalid;
 }
@@ -0,0 +1,52 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Streaming CRC-32 (IEEE 802.3, as used by zip, PNG and the crc32 command line
+//  tools). Uses a 16 entry table to keep RAM usage low. A complete CRC is computed
+//  as:
+//
+//    crc = crc32Update(CRC32_INIT, data, length) ^ CRC32_INIT
+//
+//  and longer data can be fed in chunks by passing the running value back in.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "crc32.h"
+
+static const uint32_t crcTable[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+//---------------------------------------------------------------------------------------
+// crc32Update
+//
+// Feeds a block of data into a running CRC-32
+//
+// -> crc: running value, CRC32_INIT for the first block
+//    data, length: data to add
+// <- new running value
+//---------------------------------------------------------------------------------------
+uint32_t crc32Update(uint32_t crc, const void *data, size_t length)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	while (length--)
+	{
+		crc ^= *p++;
+		crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+		crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+	}
+	return crc;
+}
@@ -0,0 +1,166 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Registry of all display effects. Each DisplayMode has one entry with its name, the
+//  index in the mode list of the web page, the frame interval and the functions to
+//  initialize, render and tear down the effect. LEDFunctionsClass::process() calls
+//  the render function of the current mode through this table, setMode() calls init
+//  and teardown. The names and web indexes are used by the web server, MQTT and the
+//  config, so a new effect only needs its entry here besides its render function.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <Arduino.h>
+#include "ledfunctions.h"
+
+typedef LEDFunctionsClass L;
+
+static_assert(EFFECT_WIDTH == LEDFunctionsClass::width && EFFECT_HEIGHT == LEDFunctionsClass::height,
+	"EFFECT_WIDTH/EFFECT_HEIGHT must match the LED matrix");
+
+// entries must be in the order of DisplayMode (checked by effectsInOrder() below)
+constexpr effect_descriptor LEDFunctionsClass::effects[NUM_EFFECTS] = {
+	{DisplayMode::plain, "plain", 0, EFFECT_INDEXED, 0,
+		nullptr, &L::renderPlain, nullptr},
+	{DisplayMode::fade, "fade", 1, 0, 0,
+		nullptr, &L::renderFade, nullptr},
+	{DisplayMode::flyingLettersVerticalUp, "flyingLettersVerticalUp", 2, EFFECT_INDEXED | EFFECT_STATE, FLYINGLETTERSINTERVAL,
+		&L::initFlyingLetters, &L::renderFlyingLetters, nullptr},
+	{DisplayMode::flyingLettersVerticalDown, "flyingLettersVerticalDown", 3, EFFECT_INDEXED | EFFECT_STATE, FLYINGLETTERSINTERVAL,
+		&L::initFlyingLetters, &L::renderFlyingLetters, nullptr},
+	{DisplayMode::explode, "explode", 4, 0, EXPLODEINTERVAL,
+		&L::initExplosion, &L::renderExplosion, &L::teardownParticles},
+	{DisplayMode::random, "random", 10, 0, 0,
+		nullptr, &L::renderRandom, nullptr},
+	{DisplayMode::matrix, "matrix", 6, EFFECT_ALARM | EFFECT_STATE, MATRIXINTERVAL,
+		nullptr, &L::renderMatrix, nullptr},
+	{DisplayMode::heart, "heart", 7, EFFECT_INDEXED | EFFECT_ALARM | EFFECT_STATE, RENDERHEARTINTERVAL,
+		nullptr, &L::renderHeart, nullptr},
+	{DisplayMode::fire, "fire", 8, EFFECT_INDEXED | EFFECT_ALARM | EFFECT_STATE, FIREINTERVAL,
+		&L::initFire, &L::renderFire, nullptr},
+	{DisplayMode::plasma, "plasma", 5, EFFECT_INDEXED | EFFECT_ALARM | EFFECT_STATE, PLASMAINTERVAL,
+		nullptr, &L::renderPlasma, nullptr},
+	{DisplayMode::stars, "stars", 9, EFFECT_ALARM | EFFECT_STATE, 0,
+		&L::initStars, &L::renderStars, nullptr},
+	{DisplayMode::wakeup, "wakeup", -1, EFFECT_INDEXED | EFFECT_ALARM, 0,
+		nullptr, &L::renderWakeup, nullptr},
+	{DisplayMode::HorizontalStripes, "HorizontalStripes", 11, 0, 0,
+		nullptr, &L::renderHorizontalStripes, nullptr},
+	{DisplayMode::VerticalStripes, "VerticalStripes", 12, 0, 0,
+		nullptr, &L::renderVerticalStripes, nullptr},
+	{DisplayMode::RandomDots, "RandomDots", 13, 0, 0,
+		nullptr, &L::renderRandomDots, nullptr},
+	{DisplayMode::RandomStripes, "RandomStripes", 14, EFFECT_STATE, 0,
+		&L::initRandomStripes, &L::renderRandomStripes, nullptr},
+	{DisplayMode::RotatingLine, "RotatingLine", 15, EFFECT_STATE, 0,
+		nullptr, &L::renderRotatingLine, nullptr},
+	{DisplayMode::red, "red", -1, EFFECT_INDEXED, 0,
+		nullptr, &L::renderRed, nullptr},
+	{DisplayMode::green, "green", -1, EFFECT_INDEXED, 0,
+		nullptr, &L::renderGreen, nullptr},
+	{DisplayMode::blue, "blue", -1, EFFECT_INDEXED, 0,
+		nullptr, &L::renderBlue, nullptr},
+	{DisplayMode::yellowHourglass, "yellowHourglass", -1, EFFECT_INDEXED | EFFECT_STATE | EFFECT_ANIMATION, 0,
+		&L::initHourglass, &L::playAnimation, &L::teardownAnimation},
+	{DisplayMode::greenHourglass, "greenHourglass", -1, EFFECT_INDEXED | EFFECT_STATE | EFFECT_ANIMATION, 0,
+		&L::initHourglass, &L::playAnimation, &L::teardownAnimation},
+	{DisplayMode::update, "update", -1, EFFECT_INDEXED | EFFECT_NOTRANSITION, 0,
+		nullptr, &L::renderUpdate, nullptr},
+	{DisplayMode::updateComplete, "updateComplete", -1, EFFECT_INDEXED | EFFECT_NOTRANSITION, 0,
+		nullptr, &L::renderUpdateComplete, nullptr},
+	{DisplayMode::updateError, "updateError", -1, EFFECT_INDEXED | EFFECT_NOTRANSITION, 0,
+		nullptr, &L::renderUpdateError, nullptr},
+	{DisplayMode::wifiManager, "wifiManager", -1, EFFECT_INDEXED | EFFECT_NOTRANSITION, 0,
+		nullptr, &L::renderWifiManager, nullptr},
+	{DisplayMode::christmastree, "ChristmasTree", 16, 0, 0,
+		nullptr, &L::renderChristmasTree, nullptr},
+	{DisplayMode::jinglebells, "JingleBells", 17, 0, 0,
+		nullptr, &L::renderJingleBells, nullptr},
+	{DisplayMode::merryChristmas, "MerryChristmas", 18, EFFECT_INDEXED | EFFECT_NIGHTPLAIN | EFFECT_STATE, 0,
+		&L::initText, &L::renderMerryChristmas, &L::teardownText},
+	{DisplayMode::happyNewYear, "HappyNewYear", 19, EFFECT_NIGHTPLAIN | EFFECT_STATE, 0,
+		&L::initText, &L::renderHappyNewYear, &L::teardownHappyNewYear},
+	{DisplayMode::animation, "animation", 20, EFFECT_INDEXED | EFFECT_STATE | EFFECT_ANIMATION, 0,
+		&L::initAnimation, &L::renderAnimation, &L::teardownAnimation},
+	{DisplayMode::scrollText, "text", -1, EFFECT_INDEXED | EFFECT_NIGHTPLAIN | EFFECT_STATE, 0,
+		&L::initText, &L::renderText, &L::teardownText},
+};
+
+//---------------------------------------------------------------------------------------
+// effectsInOrder
+//
+// Checks at compile time that every entry of the registry sits at the index of its
+// DisplayMode, as effect() and process() index the table with the mode
+//
+// -> --
+// <- true if all entries are in order
+//---------------------------------------------------------------------------------------
+static constexpr bool effectsInOrder()
+{
+	for (int i = 0; i < NUM_EFFECTS; i++)
+	{
+		if (LEDFunctionsClass::effects[i].mode != (DisplayMode)i) return false;
+	}
+	return true;
+}
+static_assert(effectsInOrder(), "effects[] must be in the order of DisplayMode");
+
+//---------------------------------------------------------------------------------------
+// effect
+//
+// Looks up the registry entry of a display mode
+//
+// -> mode: display mode
+// <- registry entry, NULL if mode is invalid
+//---------------------------------------------------------------------------------------
+const effect_descriptor *LEDFunctionsClass::effect(DisplayMode mode)
+{
+	if ((int)mode < 0 || (int)mode >= NUM_EFFECTS) return NULL;
+	return &LEDFunctionsClass::effects[(int)mode];
+}
+
+//---------------------------------------------------------------------------------------
+// effectByName
+//
+// Looks up an effect by its name, ignoring case
+//
+// -> name: effect name as used by MQTT and the alarm settings
+// <- registry entry, NULL if not found
+//---------------------------------------------------------------------------------------
+const effect_descriptor *LEDFunctionsClass::effectByName(const char *name)
+{
+	for (int i = 0; i < NUM_EFFECTS; i++)
+	{
+		if (strcasecmp(name, LEDFunctionsClass::effects[i].name) == 0) return &LEDFunctionsClass::effects[i];
+	}
+	return NULL;
+}
+
+//---------------------------------------------------------------------------------------
+// effectByWebId
+//
+// Looks up an effect by its index in the mode list of the web page
+//
+// -> webId: index sent by /setmode
+// <- registry entry, NULL if not found
+//---------------------------------------------------------------------------------------
+const effect_descriptor *LEDFunctionsClass::effectByWebId(int webId)
+{
+	if (webId < 0) return NULL;
+	for (int i = 0; i < NUM_EFFECTS; i++)
+	{
+		if (LEDFunctionsClass::effects[i].webId == webId) return &LEDFunctionsClass::effects[i];
+	}
+	return NULL;
+}
@@ -0,0 +1,108 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Heat simulation of the fire effect. Works on a plain heat buffer and does not
+//  depend on the Arduino core, so it can be benchmarked on the host (test/host).
+//  LEDFunctionsClass::renderFire() runs one step per frame and maps the heat to
+//  colors through its palette.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "firekernel.h"
+
+//---------------------------------------------------------------------------------------
+// xorshift32
+//
+// Fast pseudo random numbers for effects that need several per LED and frame
+//
+// -> state: generator state, must not be 0
+// <- next random number
+//---------------------------------------------------------------------------------------
+static inline uint32_t xorshift32(uint32_t &state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+//---------------------------------------------------------------------------------------
+// fireStep
+//
+// Advances the fire by one frame. The bottom row is seeded with random sparks, then
+// each row above takes the heat of the two rows below: a [1 2 1] kernel on the next
+// row plus 4x the cell two rows below, divided by 8. The kernel only uses shifts and
+// adds, its horizontal part slides along the row as sums of neighbouring pairs. Each
+// cell loses a random amount of heat, wind shifts the source row by one column every
+// FIRE_WINDSTEP / |wind| frames.
+//
+// -> buf: heat per LED, w * h values, row by row from the top
+//    w, h: size of the matrix, w <= FIRE_MAXWIDTH
+//    rng: xorshift32 state, must not be 0
+//    windPhase: wind accumulated since the last column shift
+//    wind: -FIRE_WINDSTEP..FIRE_WINDSTEP, negative blows to the left
+//    sparking: chance of a new spark per bottom LED in percent
+//    cooling: maximum heat a cell loses per frame, 0..100
+// <- --
+//---------------------------------------------------------------------------------------
+void fireStep(uint8_t *buf, int w, int h, uint32_t &rng, int16_t &windPhase,
+	int wind, int sparking, int cooling)
+{
+	uint8_t row[FIRE_MAXWIDTH + 2]; // source row with edge cells repeated, shifted by the wind
+	uint32_t r = 0;
+
+	// accumulate the wind, shift by one column when a full step is reached
+	int shift = 0;
+	windPhase += wind;
+	if (windPhase >= FIRE_WINDSTEP) { windPhase -= FIRE_WINDSTEP; shift = 1; }
+	else if (windPhase <= -FIRE_WINDSTEP) { windPhase += FIRE_WINDSTEP; shift = -1; }
+
+	// seed the bottom row, cells without a new spark cool down quickly
+	uint8_t *bottom = &buf[(h - 1) * w];
+	uint32_t sparkThreshold = (sparking << 8) / 100;
+	for (int x = 0; x < w; x++)
+	{
+		r = xorshift32(rng);
+		if ((r & 0xFF) < sparkThreshold) bottom[x] = 0x80 | (r >> 25);
+		else bottom[x] >>= 1;
+	}
+
+	// propagate the heat upwards, rows below are read before they are overwritten
+	for (int y = 0; y < h - 1; y++)
+	{
+		const uint8_t *next = &buf[(y + 1) * w];
+		const uint8_t *below = &buf[(y + 2 < h ? y + 2 : h - 1) * w];
+		uint8_t *target = &buf[y * w];
+
+		for (int i = 0; i < w + 2; i++)
+		{
+			int x = i - 1 - shift;
+			row[i] = next[x < 0 ? 0 : (x > w - 1 ? w - 1 : x)];
+		}
+
+		uint32_t pair = row[0] + row[1];
+		for (int x = 0; x < w; x++)
+		{
+			uint32_t nextPair = row[x + 1] + row[x + 2];
+			uint32_t heat = (pair + nextPair + (below[x] << 2)) >> 3;
+			pair = nextPair;
+
+			// one random byte per cell, four per generator step
+			if ((x & 3) == 0) r = xorshift32(rng);
+			uint32_t coolingAmount = ((r & 0xFF) * cooling) >> 7;
+			r >>= 8;
+
+			target[x] = heat > coolingAmount ? heat - coolingAmount : 0;
+		}
+	}
+}
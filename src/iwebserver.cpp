@@ -26,6 +26,8 @@
 #include "iwebserver.h"
 #include "mqtt.h"
 #include "ntp.h"
+#include "parse.h"
+#include "crc32.h"
 #include <WiFiManager.h>          //https://github.com/tzapu/WiFiManager WiFi Configuration Magic
 
 #ifdef DEBUG
@@ -35,6 +37,19 @@
 #define GETCONFIGMESSAGESIZE 2000
 #define INFOMESSAGESIZE 600
 
+// uploads are written to <name>.part and renamed when complete, <name>.part.crc holds
+// the size and running CRC of an interrupted upload so it can be resumed
+#define UPLOAD_TEMP_SUFFIX ".part"
+#define UPLOAD_STATE_SUFFIX ".crc"
+#define UPLOAD_PATH_SIZE 32
+
+// content of <name>.part.crc
+typedef struct _upload_state
+{
+  uint32_t size;                  // bytes in <name>.part
+  uint32_t crc;                   // running CRC-32 (not finalized) of these bytes
+} upload_state;
+
 //---------------------------------------------------------------------------------------
 // global instance
 //---------------------------------------------------------------------------------------
@@ -79,7 +94,9 @@ WebServerClass::~WebServerClass()
 void WebServerClass::begin()
 {
 	// LittleFS.begin(); // Also called by Config, so can be removed here
-#ifdef ESP32
+#if defined(ASYNCWEBSERVER)
+  this->server = new AsyncWebBackend(80);
+#elif defined(ESP32)
   this->server = new WebServer(80);
 #else
   this->server = new ESP8266WebServer(80);
@@ -94,6 +111,16 @@ void WebServerClass::begin()
 	this->server->on("/getadc", std::bind(&WebServerClass::handleGetADC, this));
 	this->server->on("/setmode", std::bind(&WebServerClass::handleSetMode, this));
   this->server->on("/setanimspeed", std::bind(&WebServerClass::handleSetAnimSpeed, this));
+  this->server->on("/setfade", std::bind(&WebServerClass::handleSetFade, this));
+  this->server->on("/settransition", std::bind(&WebServerClass::handleSetTransition, this));
+  this->server->on("/setdithering", std::bind(&WebServerClass::handleSetDithering, this));
+  this->server->on("/setmatrixdensity", std::bind(&WebServerClass::handleSetMatrixDensity, this));
+  this->server->on("/setfire", std::bind(&WebServerClass::handleSetFire, this));
+  this->server->on("/setanimation", std::bind(&WebServerClass::handleSetAnimation, this));
+  this->server->on("/showtext", std::bind(&WebServerClass::handleShowText, this));
+  this->server->on("/setloglevel", std::bind(&WebServerClass::handleSetLogLevel, this));
+  this->server->on("/loadcalibration", std::bind(&WebServerClass::handleLoadCalibration, this));
+  this->server->on("/clearcalibration", std::bind(&WebServerClass::handleClearCalibration, this));
 	this->server->on("/settimezone", std::bind(&WebServerClass::handleSetTimeZone, this));
   this->server->on("/resetwificredentials", std::bind(&WebServerClass::handleResetWifiCredentials, this));
   this->server->on("/factoryreset", std::bind(&WebServerClass::handleFactoryReset, this));
@@ -105,6 +132,7 @@ void WebServerClass::begin()
   this->server->on("/sethostname", std::bind(&WebServerClass::handleSetHostname, this));
   this->server->on("/upload", HTTP_GET, std::bind(&WebServerClass::sendUploadForm, this));  
   this->server->on("/upload", HTTP_POST, std::bind(&WebServerClass::sendOK, this), std::bind(&WebServerClass::handleFileUpload, this));
+  this->server->on("/uploadstatus", std::bind(&WebServerClass::handleUploadStatus, this));
 
 
 #ifdef DEBUG
@@ -121,8 +149,9 @@ void WebServerClass::begin()
 
 	this->server->onNotFound(std::bind(&WebServerClass::handleNotFound, this));
 
-  // Generic code which passess all webrequeststs.
-#ifndef ESP32
+  // Generic code which passess all webrequeststs. The async backend logs requests
+  // itself when dispatching them.
+#if !defined(ESP32) && !defined(ASYNCWEBSERVER)
   this->server->addHook([](const String & method, const String & url, WiFiClient * client, ESP8266WebServer::ContentTypeFunction contentType) {
     /* (void)method;      // GET, PUT, ...
     (void)url;         // example: /root/myfile.html
@@ -164,44 +193,207 @@ void WebServerClass::sendUploadForm()
   this->server->send(200, "text/html", (String("Use this form to upload index.html, favicon.ico and index.css<BR /><BR />")+String(HTTP_UPLOAD_FORM)).c_str());       //Response to the HTTP request
 }
 
+//---------------------------------------------------------------------------------------
+// uploadPaths
+//
+// Builds the target, temporary and upload state file names for an uploaded file
+//
+// -> name: file name as sent by the client, "/" is prepended if missing
+//    path: receives the target file name
+//    tempPath: receives the name of the temporary file
+//    statePath: receives the name of the upload state file
+// <- false if the name is empty or too long
+//---------------------------------------------------------------------------------------
+static bool uploadPaths(const char *name, char path[UPLOAD_PATH_SIZE], char tempPath[UPLOAD_PATH_SIZE],
+  char statePath[UPLOAD_PATH_SIZE])
+{
+  if (name == NULL || name[0] == 0) return false;
+  int len = snprintf(path, UPLOAD_PATH_SIZE, "%s%s", name[0] == '/' ? "" : "/", name);
+  if (len <= 1 || len >= UPLOAD_PATH_SIZE) return false;
+  len = snprintf(tempPath, UPLOAD_PATH_SIZE, "%s%s", path, UPLOAD_TEMP_SUFFIX);
+  if (len >= UPLOAD_PATH_SIZE) return false;
+  len = snprintf(statePath, UPLOAD_PATH_SIZE, "%s%s", tempPath, UPLOAD_STATE_SUFFIX);
+  return len < UPLOAD_PATH_SIZE;
+}
+
+//---------------------------------------------------------------------------------------
+// readUploadState
+//
+// Reads the state of an interrupted upload. The state is only valid if it matches
+// the size of the temporary file.
+//
+// -> tempPath: name of the temporary file
+//    statePath: name of the upload state file
+//    state: receives the upload state
+// <- true if a valid state was found
+//---------------------------------------------------------------------------------------
+static bool readUploadState(const char *tempPath, const char *statePath, upload_state &state)
+{
+  File f = LittleFS.open(statePath, "r");
+  if (!f) return false;
+  bool ok = f.read((uint8_t*)&state, sizeof(state)) == sizeof(state);
+  f.close();
+  if (!ok) return false;
+
+  f = LittleFS.open(tempPath, "r");
+  if (!f) return false;
+  ok = f.size() == state.size;
+  f.close();
+  return ok;
+}
+
+//---------------------------------------------------------------------------------------
+// writeUploadState
+//
+// Stores the state of an interrupted upload, so a resume does not have to read the
+// temporary file again to rebuild the CRC
+//
+// -> statePath: name of the upload state file
+//    size: bytes in the temporary file
+//    crc: running CRC-32 of these bytes
+// <- --
+//---------------------------------------------------------------------------------------
+static void writeUploadState(const char *statePath, uint32_t size, uint32_t crc)
+{
+  upload_state state = { size, crc };
+  File f = LittleFS.open(statePath, "w");
+  if (!f) return;
+  f.write((const uint8_t*)&state, sizeof(state));
+  f.close();
+}
+
 //---------------------------------------------------------------------------------------
 // handleFileUpload
 //
-// Store file on LittleFS 
+// Store file on LittleFS. The data is written to a temporary file while a CRC-32 is
+// calculated on the fly, the temporary file replaces the target file only if the
+// upload was complete and (if given) the checksum matches. Optional arguments:
 //
+//   offset=n     resume an interrupted upload, the posted file contains the data
+//                from byte n on, n must equal the size reported by /uploadstatus
+//   crc=xxxxxxxx expected CRC-32 (hex) of the complete file
+//
+// An interrupted upload leaves the temporary file and its size and running CRC
+// (<name>.part.crc) in place so it can be resumed without reading the file again.
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleFileUpload(){ // upload a new file to the LittleFS
-  HTTPUpload& upload = this->server->upload();
+  auto& upload = this->server->upload();
+  char path[UPLOAD_PATH_SIZE], tempPath[UPLOAD_PATH_SIZE], statePath[UPLOAD_PATH_SIZE];
+
   if(upload.status == UPLOAD_FILE_START){
-    Serial.println(F("Upload file start"));
-    String filename = upload.filename;
-    if(!filename.startsWith("/")) filename = "/"+filename;
-    Serial.print(F("handleFileUpload Name: ")); Serial.println(filename);
-    Serial.println(F("HandleFileUpload Name ")+filename);
-    fsUploadFile = LittleFS.open(filename, "w");            // Open the file for writing in LittleFS (create if it doesn't exist)
+    Serial.printf("Upload file start: %s\n", upload.filename.c_str());
+    this->uploadCrc = CRC32_INIT;
+    if (!uploadPaths(upload.filename.c_str(), path, tempPath, statePath)) {
+      this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("400: invalid file name"));
+      return;
+    }
+
+    long offset = 0;
+    if (this->server->hasArg("offset") &&
+        !parseInt(this->server->arg("offset").c_str(), offset, 0, 0x7FFFFFFF)) {
+      this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("400: invalid offset"));
+      return;
+    }
+
+    if (offset > 0) {
+      // resume: the temporary file must contain exactly the data before offset, its
+      // CRC comes from the upload state
+      upload_state state;
+      if (!readUploadState(tempPath, statePath, state) || (long)state.size != offset) {
+        this->server->send(409, FPSTR(CT_TEXT_PLAIN), F("409: offset does not match partial upload"));
+        return;
+      }
+      this->uploadCrc = state.crc;
+      fsUploadFile = LittleFS.open(tempPath, "a");
+    } else {
+      fsUploadFile = LittleFS.open(tempPath, "w");
+    }
+    LittleFS.remove(statePath);
     if (!fsUploadFile) {
       this->server->send(500, FPSTR(CT_TEXT_PLAIN), F("500: couldn't create file"));
     }
-    filename = String();
   } else if(upload.status == UPLOAD_FILE_WRITE){
-    Serial.println(F("Upload file write"));
-    if(fsUploadFile)
-      fsUploadFile.write(upload.buf, upload.currentSize); // Write the received bytes to the file
+    if(fsUploadFile) {
+      size_t size = fsUploadFile.size();
+      if (fsUploadFile.write(upload.buf, upload.currentSize) != upload.currentSize) {
+        // file system full, keep the complete chunks for a later resume
+        fsUploadFile.truncate(size);
+        fsUploadFile.close();
+        if (uploadPaths(upload.filename.c_str(), path, tempPath, statePath))
+          writeUploadState(statePath, size, this->uploadCrc);
+        this->server->send(507, FPSTR(CT_TEXT_PLAIN), F("507: write failed"));
+        return;
+      }
+      this->uploadCrc = crc32Update(this->uploadCrc, upload.buf, upload.currentSize);
+    }
   } else if(upload.status == UPLOAD_FILE_END){
     Serial.println(F("Upload file end"));
-    if(fsUploadFile) {                                    // If the file was successfully created
-      fsUploadFile.close();                               // Close the file again
-      Serial.print(F("handleFileUpload Size: ")); 
-      Serial.println(upload.totalSize);
-      // server.send(200, "text/plain", "File succesfully uploaded");
-      this->server->send(200, "text/html", (String(upload.filename)+
-                                      String(" succesfully uploaded (")+
-                                      String(upload.totalSize)+String(" bytes), do you want to upload another file?<BR /><BR />")+
-                                      String(HTTP_UPLOAD_FORM)).c_str()); // send form to upload another file
-    } else {
+    if(!fsUploadFile) {
       this->server->send(500, FPSTR(CT_TEXT_PLAIN), F("500: couldn't create file"));
+      return;
     }
+    size_t size = fsUploadFile.size();
+    fsUploadFile.close();
+    uploadPaths(upload.filename.c_str(), path, tempPath, statePath);
+
+    uint32_t crc = this->uploadCrc ^ CRC32_INIT;
+    uint32_t expected;
+    if (this->server->hasArg("crc") &&
+        (!parseHex32(this->server->arg("crc").c_str(), expected) || expected != crc)) {
+      LittleFS.remove(tempPath);
+      this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("400: checksum mismatch"));
+      return;
+    }
+
+    // LittleFS replaces an existing target atomically
+    if (!LittleFS.rename(tempPath, path)) {
+      this->server->send(500, FPSTR(CT_TEXT_PLAIN), F("500: couldn't rename file"));
+      return;
+    }
+    Serial.printf("handleFileUpload: %s, %u bytes, crc %08x\n", path, size, crc);
+
+    char message[128];
+    snprintf(message, sizeof(message), "%s succesfully uploaded (%u bytes, crc %08x), do you want to upload another file?<BR /><BR />",
+      path, size, crc);
+    this->server->send(200, "text/html", String(message)+FPSTR(HTTP_UPLOAD_FORM)); // send form to upload another file
+  } else if(upload.status == UPLOAD_FILE_ABORTED){
+    Serial.println(F("Upload file aborted"));
+    if(fsUploadFile) {
+      size_t size = fsUploadFile.size();
+      fsUploadFile.close();
+      if (uploadPaths(upload.filename.c_str(), path, tempPath, statePath))
+        writeUploadState(statePath, size, this->uploadCrc);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// handleUploadStatus
+//
+// Handles the /uploadstatus?name=xxx request, reports how many bytes of an interrupted
+// upload are present and can be skipped using the offset argument of /upload. Reports
+// 0 if the upload state is missing (e. g. after a power loss during the upload).
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleUploadStatus()
+{
+  char path[UPLOAD_PATH_SIZE], tempPath[UPLOAD_PATH_SIZE], statePath[UPLOAD_PATH_SIZE];
+
+  if (!this->server->hasArg("name") ||
+      !uploadPaths(this->server->arg("name").c_str(), path, tempPath, statePath)) {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_ERR));
+    return;
   }
+
+  // a partial upload without a matching state can not be resumed, start over
+  upload_state state;
+  uint32_t size = readUploadState(tempPath, statePath, state) ? state.size : 0;
+
+  char message[96];
+  snprintf(message, sizeof(message), "{\"name\":\"%s\",\"offset\":%u}", path, size);
+  this->server->send(200, FPSTR(CT_APP_JSON), message);
 }
 
 
@@ -227,7 +419,8 @@ bool WebServerClass::endsWith(const char* what, const char* withwhat)
 //---------------------------------------------------------------------------------------
 // process
 //
-// Must be called repeatedly from main loop
+// Must be called repeatedly from main loop. With ASYNCWEBSERVER this only runs the
+// handlers of requests which have been received completely in the background.
 //
 // ->
 // <- --
@@ -376,16 +569,20 @@ void WebServerClass::handleDebug()
     if(b < 0) b = 0;
     if(b > 255) b = 255;
 
+    LED.materialize();
     LED.currentValues[led*3+0] = r;
     LED.currentValues[led*3+1] = g;
     LED.currentValues[led*3+2] = b;
+    LED.commit();
     LED.show();
     Config.debugMode = 1;
   }
 
   if(this->server->hasArg("clear"))
   {
+    LED.materialize();
     for(int i=0; i<3*NUM_PIXELS; i++) LED.currentValues[i] = 0;
+    LED.commit();
     LED.show();
   }
 
@@ -507,10 +704,11 @@ void WebServerClass::handleClearCrashLog()
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleSetBrightness()
 {
-	if(this->server->hasArg("value"))
+  long value;
+	if(this->server->hasArg("value") && parseInt(this->server->arg("value").c_str(), value, 0, 256))
 	{
     Serial.println(F("SetBrightness"));
-		Brightness.brightnessOverride = this->server->arg("value").toInt();
+		Brightness.brightnessOverride = value;
     Config.save();
 		this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
 	}
@@ -527,9 +725,10 @@ void WebServerClass::handleSetBrightness()
 void WebServerClass::handleSetNightMode()
 {
   Serial.println(F("SetNightMode"));
-  if(this->server->hasArg("value"))
+  bool value;
+  if(this->server->hasArg("value") && parseBool(this->server->arg("value").c_str(), value))
   {
-    Config.nightmode = (this->server->hasArg("value") && this->server->arg("value") == "1");
+    Config.nightmode = value;
     Config.saveDelayed();
     this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
   }
@@ -556,11 +755,10 @@ void WebServerClass::handleGetADC()
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleSetTimeZone()
 {
-  int newTimeZone = -999;
+  long newTimeZone;
 	if(this->server->hasArg("value"))
 	{
-		newTimeZone = this->server->arg("value").toInt();
-		if(newTimeZone < - 12 || newTimeZone > 14)
+		if(!parseInt(this->server->arg("value").c_str(), newTimeZone, -12, 14))
 		{
 			this->server->send(400, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_ERR));
 		}
@@ -575,6 +773,284 @@ void WebServerClass::handleSetTimeZone()
 }
 
 
+//---------------------------------------------------------------------------------------
+// handleSetFade
+//
+// Handles the /setfade?duration=<ms>&easing=<stepped|linear|gamma|easeinout> request,
+// both arguments are optional
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetFade()
+{
+  long duration = Config.fadeDuration;
+  FadeEasing easing = Config.fadeEasing;
+
+  if (this->server->hasArg("duration") &&
+      !parseInt(this->server->arg("duration").c_str(), duration, FADEDURATION_MIN, FADEDURATION_MAX))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Duration should be 50..10000 ms"));
+    return;
+  }
+  if (this->server->hasArg("easing"))
+  {
+    easing = ConfigClass::fadeEasingFromName(this->server->arg("easing").c_str());
+    if (easing == FadeEasing::invalid)
+    {
+      this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Easing should be stepped, linear, gamma or easeinout"));
+      return;
+    }
+  }
+
+  Config.fadeDuration = duration;
+  Config.fadeEasing = easing;
+  Config.saveDelayed();
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
+//---------------------------------------------------------------------------------------
+// handleSetTransition
+//
+// Handles the /settransition?type=<none|crossfade|wipe|dissolve>&duration=<ms> request,
+// both arguments are optional
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetTransition()
+{
+  long duration = Config.transitionDuration;
+  TransitionType transition = Config.transition;
+
+  if (this->server->hasArg("duration") &&
+      !parseInt(this->server->arg("duration").c_str(), duration, TRANSITIONDURATION_MIN, TRANSITIONDURATION_MAX))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Duration should be 100..5000 ms"));
+    return;
+  }
+  if (this->server->hasArg("type"))
+  {
+    transition = ConfigClass::transitionFromName(this->server->arg("type").c_str());
+    if (transition == TransitionType::invalid)
+    {
+      this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Type should be none, crossfade, wipe or dissolve"));
+      return;
+    }
+  }
+
+  Config.transitionDuration = duration;
+  Config.transition = transition;
+  Config.saveDelayed();
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
+//---------------------------------------------------------------------------------------
+// handleSetDithering
+//
+// Enables or disables temporal dithering of the LED output based on argument "value"
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetDithering()
+{
+  bool value = false;
+  if (this->server->hasArg("value")) parseBool(this->server->arg("value").c_str(), value);
+  Config.dithering = value;
+  Config.saveDelayed();
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
+//---------------------------------------------------------------------------------------
+// handleSetMatrixDensity
+//
+// Handles the /setmatrixdensity request. Sets the density of the matrix rain between
+// 1..100
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetMatrixDensity()
+{
+  long density;
+  if (!this->server->hasArg("value"))
+  {
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), F("Missing value"));
+  }
+  else if (parseInt(this->server->arg("value").c_str(), density, 1, 100))
+  {
+    Config.matrixDensity = density;
+    Config.saveDelayed();
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+  }
+  else
+  {
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), F("Value should be min 1 or max 100"));
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// handleSetLogLevel
+//
+// Handles the /setloglevel request. Sets the level of the serial output until the next
+// restart: 0 = errors, 1 = info, 2 = debug
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetLogLevel()
+{
+  long level;
+  if (!this->server->hasArg("value"))
+  {
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), F("Missing value"));
+  }
+  else if (parseInt(this->server->arg("value").c_str(), level, LOG_ERROR, LOG_DEBUG))
+  {
+    Config.logLevel = level;
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+  }
+  else
+  {
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), F("Value should be min 0 or max 2"));
+  }
+}
+
+//---------------------------------------------------------------------------------------
+// handleSetFire
+//
+// Sets the parameters of the fire effect based on the optional arguments "cooling"
+// (0..100), "sparking" (0..100) and "wind" (-100..100)
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetFire()
+{
+  long cooling = Config.fireCooling;
+  long sparking = Config.fireSparking;
+  long wind = Config.fireWind;
+
+  if (this->server->hasArg("cooling") &&
+      !parseInt(this->server->arg("cooling").c_str(), cooling, 0, FIRECOOLING_MAX))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Cooling should be 0..100"));
+    return;
+  }
+  if (this->server->hasArg("sparking") &&
+      !parseInt(this->server->arg("sparking").c_str(), sparking, 0, FIRESPARKING_MAX))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Sparking should be 0..100"));
+    return;
+  }
+  if (this->server->hasArg("wind") &&
+      !parseInt(this->server->arg("wind").c_str(), wind, -FIREWIND_MAX, FIREWIND_MAX))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Wind should be -100..100"));
+    return;
+  }
+
+  Config.fireCooling = cooling;
+  Config.fireSparking = sparking;
+  Config.fireWind = wind;
+  Config.saveDelayed();
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
+//---------------------------------------------------------------------------------------
+// handleSetAnimation
+//
+// Plays the animation file given by argument "file" after it has been uploaded using
+// /upload. The file is reopened even if it is already playing under the same name.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleSetAnimation()
+{
+  char path[CONFIGSTRINGSIZE];
+  AnimationPlayer player;
+
+  if (!this->server->hasArg("file") ||
+      snprintf(path, sizeof(path), "%s%s", this->server->arg("file")[0] == '/' ? "" : "/",
+        this->server->arg("file").c_str()) >= (int) sizeof(path) ||
+      !player.open(path))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("400: missing or invalid animation file"));
+    return;
+  }
+  player.close();
+
+  strcpy(Config.animationFile, path);
+  Config.defaultMode = DisplayMode::animation;
+  LED.reloadAnimation();
+  Config.saveDelayed();
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
+//---------------------------------------------------------------------------------------
+// handleShowText
+//
+// Scrolls the text given by argument "text" over the display, optional arguments are
+// "color" (hexadecimal HTML color, default foreground color) and "repeat" (1..10)
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleShowText()
+{
+  palette_entry color = Config.fg;
+  long repeat = 1;
+
+  if (!this->server->hasArg("text") || this->server->arg("text").length() == 0)
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("400: missing text"));
+    return;
+  }
+  if (this->server->hasArg("repeat") &&
+      !parseInt(this->server->arg("repeat").c_str(), repeat, 1, 10))
+  {
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("Repeat should be 1..10"));
+    return;
+  }
+  this->extractColor("color", color);
+
+  LED.showText(this->server->arg("text").c_str(), color, repeat);
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
+//---------------------------------------------------------------------------------------
+// handleLoadCalibration
+//
+// Activates the per LED color calibration after calibration.bin has been uploaded
+// using /upload
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleLoadCalibration()
+{
+  if (LED.loadCalibration())
+    this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+  else
+    this->server->send(400, FPSTR(CT_TEXT_PLAIN), F("400: missing or invalid calibration file"));
+}
+
+//---------------------------------------------------------------------------------------
+// handleClearCalibration
+//
+// Removes the per LED color calibration
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void WebServerClass::handleClearCalibration()
+{
+  LED.clearCalibration();
+  this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
+}
+
 //---------------------------------------------------------------------------------------
 // handleSetAnimspeed
 //
@@ -587,11 +1063,9 @@ void WebServerClass::handleSetAnimSpeed()
 {
   if(this->server->hasArg("value"))
   {
-    // get value
-    byte animspeed=this->server->arg("value").toInt();
-    
-    // Check value
-    if (animspeed>0&&animspeed<=100)
+    // get and check value
+    long animspeed;
+    if (parseInt(this->server->arg("value").c_str(), animspeed, 1, 100))
     {
       Config.animspeed=animspeed;
       Config.saveDelayed();
@@ -616,47 +1090,25 @@ void WebServerClass::handleSetAnimSpeed()
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleSetMode()
 {
-	DisplayMode mode = DisplayMode::invalid;
+	const effect_descriptor *effect = NULL;
+	long value;
 
-	if(this->server->hasArg("value"))
+	// only modes with an index in the web page's list can be selected
+	if(this->server->hasArg("value") &&
+			parseInt(this->server->arg("value").c_str(), value, 0, NUM_EFFECTS - 1))
 	{
-		// handle each allowed value for safety
-		if(this->server->arg("value") == "0") mode = DisplayMode::plain;
-		if(this->server->arg("value") == "1") mode = DisplayMode::fade;
-		if(this->server->arg("value") == "2") mode = DisplayMode::flyingLettersVerticalUp;
-		if(this->server->arg("value") == "3") mode = DisplayMode::flyingLettersVerticalDown;
-		if(this->server->arg("value") == "4") mode = DisplayMode::explode;
-    if(this->server->arg("value") == "5") mode = DisplayMode::plasma;
-    if(this->server->arg("value") == "6") mode = DisplayMode::matrix;
-    if(this->server->arg("value") == "7") mode = DisplayMode::heart;
-    if(this->server->arg("value") == "8") mode = DisplayMode::fire;
-    if(this->server->arg("value") == "9") mode = DisplayMode::stars;
-    if(this->server->arg("value") == "10") mode = DisplayMode::random;
-    if(this->server->arg("value") == "11") mode = DisplayMode::HorizontalStripes;
-    if(this->server->arg("value") == "12") mode = DisplayMode::VerticalStripes;
-    if(this->server->arg("value") == "13") mode = DisplayMode::RandomDots;
-    if(this->server->arg("value") == "14") mode = DisplayMode::RandomStripes;
-    if(this->server->arg("value") == "15") 
-    {
-      mode = DisplayMode::RotatingLine;
-      LED.X1=0;
-      LED.Y1=0;
-    }
-    if(this->server->arg("value") == "16") mode = DisplayMode::christmastree;
-    if(this->server->arg("value") == "17") mode = DisplayMode::jinglebells;
-    if(this->server->arg("value") == "18") mode = DisplayMode::merryChristmas;
-    if(this->server->arg("value") == "19") mode = DisplayMode::happyNewYear;
+		effect = LEDFunctionsClass::effectByWebId(value);
 	}
 
-	if(mode == DisplayMode::invalid)
+	if(effect == NULL)
 	{
 		this->server->send(400, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_ERR));
 	}
 	else
 	{
-		LED.setMode(mode);
+		LED.setMode(effect->mode);
     LED.lastOffset=0; // in case of moving effects, reset from start
-		Config.defaultMode = mode;
+		Config.defaultMode = effect->mode;
 		Config.save();
 		this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
 	}
@@ -705,9 +1157,11 @@ void WebServerClass::handleSetNtpServer()
 {
 	if (this->server->hasArg("ip"))
 	{
-		IPAddress ip;
-		if (ip.fromString(this->server->arg("ip")))
+		uint8_t a[4];
+		if (parseIP(this->server->arg("ip").c_str(), a))
 		{
+			IPAddress ip(a[0], a[1], a[2], a[3]);
+
 			// set IP address in config
 			Config.ntpserver = ip;
 			Config.save();
@@ -808,20 +1262,11 @@ void WebServerClass::handleInfo()
 //	result: Pointer to palette_entry struct to receive result
 // <- --
 //---------------------------------------------------------------------------------------
-void WebServerClass::extractColor(char argName[], palette_entry& result)
+void WebServerClass::extractColor(const char argName[], palette_entry& result)
 {
-	char c[3];
-
-
-	if (this->server->hasArg(argName) && this->server->arg(argName).length() == 6)
+	if (this->server->hasArg(argName))
 	{
-		String color = this->server->arg(argName);
-		color.substring(0, 2).toCharArray(c, sizeof(c));
-		result.r = strtol(c, NULL, 16);
-		color.substring(2, 4).toCharArray(c, sizeof(c));
-		result.g = strtol(c, NULL, 16);
-		color.substring(4, 6).toCharArray(c, sizeof(c));
-		result.b = strtol(c, NULL, 16);
+		parseHexColor(this->server->arg(argName).c_str(), result.r, result.g, result.b);
 	}
 }
 
@@ -837,9 +1282,9 @@ void WebServerClass::extractColor(char argName[], palette_entry& result)
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleSetColor()
 {
-  this->extractColor((char *)"fg", Config.fg);
-	this->extractColor((char *)"bg", Config.bg);
-	this->extractColor((char *)"s", Config.s);
+  this->extractColor("fg", Config.fg);
+	this->extractColor("bg", Config.bg);
+	this->extractColor("s", Config.s);
 	this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
 	Config.saveDelayed();
 }
@@ -847,7 +1292,7 @@ void WebServerClass::handleSetColor()
 //---------------------------------------------------------------------------------------
 // handleSaveConfig
 //
-// Saves the current configuration to EEPROM
+// Saves the current configuration to flash
 //
 // -> --
 // <- --
@@ -855,20 +1300,20 @@ void WebServerClass::handleSetColor()
 void WebServerClass::handleSaveConfig()
 {
   Serial.println(F("handleSaveConfig"));
-  String Message;
   
   // for Debugging purposes
-  Serial.println(String(F("Handling Command: Number of args received: "))+this->server->args());
+  Serial.printf("Handling Command: Number of args received: %d\n", this->server->args());
   for (int i = 0; i < this->server->args(); i++) {
-    Serial.println (String(F("Argument "))+String(i)+F(" -> ")+this->server->argName(i)+F(": ")+this->server->arg(i));
+    Serial.printf("Argument %d -> %s: %s\n", i, this->server->argName(i).c_str(), this->server->arg(i).c_str());
   } 
 
   // try to deserialize
   JsonDocument json;
   DeserializationError error = deserializeJson(json, this->server->arg("plain"));
   if (error) {
-    Message=String("Invalid JSON: ")+error.f_str();
-    this->server->send(500, "text/plain", Message.c_str());
+    char message[64];
+    snprintf(message, sizeof(message), "Invalid JSON: %s", error.c_str());
+    this->server->send(500, "text/plain", message);
     return;
   } else {
     //save the custom parameters to FS
@@ -877,9 +1322,11 @@ void WebServerClass::handleSaveConfig()
     // hostname
     strncpy(Config.hostname,json["hostname"],CONFIGSTRINGSIZE);
     // ntp server    
-    IPAddress ip;
-		if (ip.fromString(String(json["ntpserver"])))
+    uint8_t a[4];
+		if (parseIP(json["ntpserver"].as<const char*>(), a))
 		{
+			IPAddress ip(a[0], a[1], a[2], a[3]);
+
 			// set IP address in config
 			Config.ntpserver = ip;
 
@@ -918,7 +1365,7 @@ void WebServerClass::handleSaveConfig()
 //---------------------------------------------------------------------------------------
 // handleLoadConfig
 //
-// Loads the current configuration from EEPROM
+// Loads the current configuration from flash
 //
 // -> --
 // <- --
@@ -939,7 +1386,9 @@ void WebServerClass::handleLoadConfig()
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleSetHeartbeat()
 {
-	Config.heartbeat = (this->server->hasArg("value") && this->server->arg("value") == "1");
+	bool value = false;
+	if (this->server->hasArg("value")) parseBool(this->server->arg("value").c_str(), value);
+	Config.heartbeat = value;
 	Config.save();
 	this->server->send(200, FPSTR(CT_TEXT_PLAIN), FPSTR(HTTP_OK));
 }
@@ -954,20 +1403,22 @@ void WebServerClass::handleSetHeartbeat()
 //---------------------------------------------------------------------------------------
 void WebServerClass::handleSetAlarm()
 {
-  if (this->server->hasArg("number")) {
-    
-    int i = this->server->arg("number").toInt();
+  long i;
+  if (this->server->hasArg("number") &&
+      parseInt(this->server->arg("number").c_str(), i, 0, sizeof(Config.alarm)/sizeof(Config.alarm[0])-1)) {
 
     if (this->server->hasArg("time")) {
       // set time
-      int index=this->server->arg("time").indexOf(":");
-      int length=this->server->arg("time").length();
-      Config.alarm[i].h=this->server->arg("time").substring(0,index).toInt();
-      Config.alarm[i].m=this->server->arg("time").substring(index+1,length).toInt();
+      int h, m;
+      if (parseTime(this->server->arg("time").c_str(), h, m)) {
+        Config.alarm[i].h=h;
+        Config.alarm[i].m=m;
+      }
     }
 
-    if (this->server->hasArg("duration")) {
-      Config.alarm[i].duration=server->arg("duration").toInt();
+    long duration;
+    if (this->server->hasArg("duration") && parseInt(this->server->arg("duration").c_str(), duration, 0, 255)) {
+      Config.alarm[i].duration=duration;
     }
 
     
@@ -978,18 +1429,9 @@ void WebServerClass::handleSetAlarm()
     }
 
     if (this->server->hasArg("mode")) {
-      if (this->server->arg("mode").equalsIgnoreCase("matrix")) 
-        Config.alarm[i].mode = DisplayMode::matrix; 
-      else if (this->server->arg("mode").equalsIgnoreCase("plasma"))
-        Config.alarm[i].mode = DisplayMode::plasma; 
-      else if (this->server->arg("mode").equalsIgnoreCase("fire"))
-        Config.alarm[i].mode = DisplayMode::fire; 
-      else if (this->server->arg("mode").equalsIgnoreCase("heart"))
-        Config.alarm[i].mode = DisplayMode::heart;
-      else if (this->server->arg("mode").equalsIgnoreCase("stars"))
-        Config.alarm[i].mode = DisplayMode::stars;
-      else if (this->server->arg("mode").equalsIgnoreCase("wakeup"))
-        Config.alarm[i].mode = DisplayMode::wakeup;
+      const effect_descriptor *effect = LEDFunctionsClass::effectByName(this->server->arg("mode").c_str());
+      if (effect != NULL && (effect->flags & EFFECT_ALARM))
+        Config.alarm[i].mode = effect->mode;
       else
         Config.alarm[i].mode = DisplayMode::plasma;  // default
     }
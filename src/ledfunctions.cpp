@@ -6,6 +6,23 @@
 //  either simple set operations or integrated screensavers (matrix, stars, heart).
 //  Also contains part of the data and logic for the hourglass animation.
 //
+//  The current state is the back buffer of the frame being rendered. commit() copies
+//  a completed frame to the front buffer, which is the only buffer show() reads.
+//
+//  Modes which only display an indexed buffer without fading (time display, hourglass,
+//  update screens, fire, ...) keep their frame in indexed form: set() stores the
+//  indexes and the palette, and commit() expands them to RGB once while filling the
+//  front buffer. The RGB buffers are only filled (materialize()) when a mode needs them
+//  for fading or direct pixel access.
+//  While the DMA engine is still sending the previous frame, process() renders the
+//  next one and skips the output instead of waiting.
+//
+//  process() renders the current mode through the effect registry (effects.cpp).
+//
+//  An optional per LED calibration (gain and offset per channel, CALIBRATIONFILE) is
+//  premultiplied with the brightness whenever one of them changes, so show() still
+//  needs a single multiplication per channel.
+//
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
 // the Free Software Foundation, either version 3 of the License, or
@@ -20,6 +37,11 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ledfunctions.h"
 #include "ntp.h"
+#include "gamma.h"
+#include "fadestep.h"
+#include "firekernel.h"
+#include "crc32.h"
+#include <LittleFS.h>
 //---------------------------------------------------------------------------------------
 #if 1 // variables
 //---------------------------------------------------------------------------------------
@@ -29,45 +51,37 @@
 //---------------------------------------------------------------------------------------
 LEDFunctionsClass LED = LEDFunctionsClass();
 
-uint8_t __attribute__((aligned(4))) fireBuf[NUM_PIXELS];
-uint8_t plasmaBuf[NUM_PIXELS];
-
-//---------------------------------------------------------------------------------------
-// Shared letter patterns for text animations
-// Capital letters are 10 pixels high (rows 0-9)
-// Lowercase letters are 7 pixels high (rows 3-9)
-//---------------------------------------------------------------------------------------
-// Capital letters (10 pixels high)
-static const uint8_t LETTER_M_CAP[10] = {0b10001, 0b11011, 0b10101, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001};
-static const uint8_t LETTER_C_CAP[10] = {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110};
-static const uint8_t LETTER_H_CAP[10] = {0b10001, 0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001};
-static const uint8_t LETTER_A_CAP[10] = {0b01110, 0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001};
-static const uint8_t LETTER_P_CAP[10] = {0b11110, 0b10001, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000};
-static const uint8_t LETTER_Y_CAP[10] = {0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100};
-static const uint8_t LETTER_N_CAP[10] = {0b10001, 0b11001, 0b11001, 0b10101, 0b10101, 0b10011, 0b10011, 0b10001, 0b10001, 0b10001};
-static const uint8_t LETTER_E_CAP[10] = {0b11111, 0b10000, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111};
-static const uint8_t LETTER_W_CAP[10] = {0b10001, 0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b11011, 0b10001, 0b10001};
-static const uint8_t LETTER_R_CAP[10] = {0b11110, 0b10001, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001, 0b10001, 0b10001};
-
-// Lowercase letters (7 pixels high, rows 3-9)
-static const uint8_t LETTER_e_LOW[10] = {0b00000, 0b00000, 0b00000, 0b01110, 0b10001, 0b11111, 0b10000, 0b10001, 0b01110, 0b00000};
-static const uint8_t LETTER_r_LOW[10] = {0b00000, 0b00000, 0b00000, 0b10110, 0b11001, 0b10000, 0b10000, 0b10000, 0b10000, 0b00000};
-static const uint8_t LETTER_y_LOW[10] = {0b00000, 0b00000, 0b00000, 0b10001, 0b10001, 0b10011, 0b01101, 0b00001, 0b00010, 0b01100};
-static const uint8_t LETTER_h_LOW[10] = {0b10000, 0b10000, 0b10000, 0b10110, 0b11001, 0b10001, 0b10001, 0b10001, 0b10001, 0b00000};
-static const uint8_t LETTER_i_LOW[10] = {0b00000, 0b00100, 0b00000, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110, 0b00000};
-static const uint8_t LETTER_s_LOW[10] = {0b00000, 0b00000, 0b00000, 0b01110, 0b10000, 0b01110, 0b00001, 0b10001, 0b01110, 0b00000};
-static const uint8_t LETTER_t_LOW[10] = {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00100, 0b00101, 0b00010, 0b00000};
-static const uint8_t LETTER_a_LOW[10] = {0b00000, 0b00000, 0b00000, 0b01110, 0b00001, 0b01111, 0b10001, 0b10011, 0b01101, 0b00000};
-static const uint8_t LETTER_m_LOW[10] = {0b00000, 0b00000, 0b00000, 0b10001, 0b11011, 0b10101, 0b10101, 0b10101, 0b10001, 0b00000};
-static const uint8_t LETTER_p_LOW[10] = {0b00000, 0b00000, 0b00000, 0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000};
-static const uint8_t LETTER_w_LOW[10] = {0b00000, 0b00000, 0b00000, 0b10001, 0b10001, 0b10101, 0b10101, 0b11011, 0b10001, 0b00000};
-static const uint8_t LETTER_SPACE[10] = {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000};
-
 //---------------------------------------------------------------------------------------
 // variables in PROGMEM (mapping table, images)
 //---------------------------------------------------------------------------------------
 #include "hourglass_animation.h"
 
+// Santa with sleigh and reindeer (21x10) for the christmas greeting, column by column,
+// indexes into the palette of renderMerryChristmas()
+static const uint8_t PROGMEM santaSleighSprite[21 * SCROLLTEXT_HEIGHT] = {
+	0, 0, 0, 0, 4, 0, 0, 0, 0, 0,
+	0, 0, 0, 4, 4, 4, 0, 0, 0, 0,
+	0, 5, 4, 4, 0, 4, 4, 4, 5, 0,
+	5, 0, 0, 4, 4, 4, 0, 0, 0, 0,
+	0, 5, 4, 4, 4, 4, 0, 0, 0, 0,
+	5, 0, 0, 4, 4, 4, 4, 4, 5, 0,
+	0, 5, 4, 0, 4, 4, 4, 0, 0, 0,
+	0, 0, 0, 4, 0, 4, 4, 0, 0, 0,
+	0, 0, 0, 0, 0, 4, 0, 4, 5, 0,
+	0, 0, 0, 0, 0, 6, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 6, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 6, 0, 0, 0, 0,
+	0, 0, 6, 6, 6, 6, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 6, 0, 0, 0, 0,
+	0, 0, 0, 0, 7, 6, 0, 7, 0, 0,
+	0, 0, 0, 0, 0, 7, 7, 7, 8, 8,
+	0, 0, 0, 0, 0, 7, 7, 7, 8, 8,
+	0, 0, 0, 9, 0, 7, 7, 7, 8, 8,
+	10, 1, 1, 9, 1, 1, 1, 7, 8, 8,
+	0, 10, 1, 10, 10, 1, 1, 7, 8, 8,
+	0, 0, 10, 10, 10, 1, 7, 7, 8, 8
+};
+
 // This defines the LED output for different minutes
 // param0 controls whether the hour has to be incremented for the given minutes
 // param1 is the matching minimum minute count (inclusive)
@@ -313,36 +327,18 @@ const uint32_t PROGMEM LEDFunctionsClass::brightnessCurvesB[256*NUM_BRIGHTNESS_C
 //---------------------------------------------------------------------------------------
 LEDFunctionsClass::~LEDFunctionsClass()
 {
-//	for(MatrixObject* m : this->matrix_objects) delete m;
 }
 
 //---------------------------------------------------------------------------------------
 // LEDFunctionsClass
 //
-// Constructor, initializes data structures
+// Constructor, effect data is allocated by setMode() when an effect starts
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
 LEDFunctionsClass::LEDFunctionsClass()
 {
-	// initialize matrix objects with random coordinates
-	for (int i = 0; i < NUM_MATRIX_OBJECTS; i++)
-	{
-		this->matrix.push_back(MatrixObject());
-	}
-
-	for (int i = 0; i < NUM_STARS; i++) this->stars.push_back(StarObject());
-
-	for (StarObject& s : this->stars) s.randomize(this->stars);
-
-	for (int i = 0; i < NUM_STARS; i++) {
-		this->stars.push_back(StarObject());
-	}
-
-	for (StarObject& s : this->stars) {
-		s.randomize(this->stars);
-	}
 }
 //---------------------------------------------------------------------------------------
 // begin
@@ -364,6 +360,87 @@ void LEDFunctionsClass::begin(int pin)
     return;
   }
   this->strip->Begin();
+  this->loadCalibration();
+}
+
+//---------------------------------------------------------------------------------------
+// loadCalibration
+//
+// Loads the per LED color calibration from CALIBRATIONFILE. The previous calibration
+// stays active if the file is missing or invalid.
+//
+// -> --
+// <- true if a valid calibration was loaded
+//---------------------------------------------------------------------------------------
+bool LEDFunctionsClass::loadCalibration()
+{
+	calibration_header header;
+
+	File f = LittleFS.open(CALIBRATIONFILE, "r");
+	if (!f) return false;
+
+	calibration_entry *entries = new calibration_entry[NUM_PIXELS];
+	bool ok = f.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+		header.magic == CALIBRATIONMAGIC &&
+		header.count == NUM_PIXELS &&
+		f.read((uint8_t*)entries, NUM_PIXELS * sizeof(calibration_entry)) == NUM_PIXELS * sizeof(calibration_entry) &&
+		(crc32Update(CRC32_INIT, entries, NUM_PIXELS * sizeof(calibration_entry)) ^ CRC32_INIT) == header.crc;
+	f.close();
+	if (!ok)
+	{
+		Serial.println(F("loadCalibration: invalid calibration file"));
+		delete[] entries;
+		return false;
+	}
+
+	delete[] this->calibration;
+	this->calibration = entries;
+	if (this->calibrationChannels == nullptr)
+		this->calibrationChannels = new calibration_channel[NUM_PIXELS * 3];
+	this->updateCalibration();
+	Serial.println(F("loadCalibration: calibration loaded"));
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// clearCalibration
+//
+// Removes the calibration file and returns to uncalibrated output
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::clearCalibration()
+{
+	LittleFS.remove(CALIBRATIONFILE);
+	delete[] this->calibration;
+	delete[] this->calibrationChannels;
+	this->calibration = nullptr;
+	this->calibrationChannels = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+// updateCalibration
+//
+// Premultiplies the calibration of each channel with the current brightness, must be
+// called whenever one of them changes
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::updateCalibration()
+{
+	if (this->calibration == nullptr) return;
+	calibration_channel *channel = this->calibrationChannels;
+	for (int i = 0; i < NUM_PIXELS; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			channel->scale = (this->calibration[i].gain[k] * this->brightness) >> 7;
+			channel->offset = this->calibration[i].offset[k] * this->brightness;
+			channel++;
+		}
+	}
 }
 
 
@@ -388,128 +465,49 @@ void LEDFunctionsClass::process()
 	if (NTP.s > 59 || NTP.s < 0) NTP.s = 0;
 	if (NTP.ms > 999 || NTP.ms < 0) NTP.ms = 0;
 
-	// load palette colors from configuration
-	palette_entry palette[] = {
-		{Config.bg.r, Config.bg.g, Config.bg.b},
-		{Config.fg.r, Config.fg.g, Config.fg.b},
-		{Config.s.r,  Config.s.g,  Config.s.b}};
-	uint8_t buf[NUM_PIXELS];
+	// setMode() only accepts modes with a registry entry
+	const effect_descriptor *effect = &LEDFunctionsClass::effects[(int)this->mode];
 
-	switch(this->mode)
-	{
-	case DisplayMode::wifiManager:
-		this->renderWifiManager();
-		break;
-	case DisplayMode::yellowHourglass:
-		this->renderHourglass(false);
-		break;
-	case DisplayMode::greenHourglass:
-		this->renderHourglass(true);
-		break;
-	case DisplayMode::update:
-		this->renderUpdate();
-		break;
-	case DisplayMode::updateComplete:
-		this->renderUpdateComplete();
-		break;
-	case DisplayMode::updateError:
-		this->renderUpdateError();
-		break;
-	case DisplayMode::red:
-		this->renderRed();
-		break;
-	case DisplayMode::green:
-		this->renderGreen();
-		break;
-	case DisplayMode::blue:
-		this->renderBlue();
-		break;
-	case DisplayMode::flyingLettersVerticalUp:
-	case DisplayMode::flyingLettersVerticalDown:
-		this->renderFlyingLetters();
-		break;
-	case DisplayMode::explode:
-		this->renderExplosion();
-		break;
-	case DisplayMode::matrix:
-		this->renderMatrix();
-		break;
-	case DisplayMode::heart:
-		this->renderHeart();
-		break;
-	case DisplayMode::stars:
-		this->renderStars();
-		break;
-	case DisplayMode::fire:
-		this->renderFire();
-		break;
-	case DisplayMode::plasma:
-		this->renderPlasma();
-		break;
-	case DisplayMode::wakeup:
-		this->renderWakeup();
-		break;
-	case DisplayMode::random:
-		this->renderRandom(buf);
-		break;
-	case DisplayMode::HorizontalStripes:
-		this->renderStripes(buf, true);
-		break;
-	case DisplayMode::VerticalStripes:
-		this->renderStripes(buf, false);
-		break;
-	case DisplayMode::RandomDots:
-		this->renderRandomDots();
-		break;
-	case DisplayMode::RandomStripes:
-		this->renderRandomStripes();
-		break;
-	case DisplayMode::RotatingLine:
-		this->renderRotatingLine();
-		break;
-	case DisplayMode::christmastree:
-		this->renderChristmasTree();
-		break;
-	case DisplayMode::jinglebells:
-		this->renderJingleBells();
-		break;
-	case DisplayMode::merryChristmas:
-		// in nightmode, show rendertime instead of christmas greeting
-		if (Config.nightmode) {
-			this->renderTime(buf);
-			this->set(buf, palette, true);
-			break;
-		} else {
-			this->renderMerryChristmas();
-			break;
-		}
-	case DisplayMode::happyNewYear:
-		// in nightmode, show rendertime instead of new year greeting
-		if (Config.nightmode) {
-			this->renderTime(buf);
-			this->set(buf, palette, true);
-			break;
-		} else {
-			this->renderHappyNewYear();
-			break;
-		}
-	case DisplayMode::fade:
-		this->renderTime(buf);
-		this->set(buf, palette, false);
-		this->fade();
-		break;
+	// RGB based modes need the indexed frame expanded to the RGB buffers
+	this->allowIndexed = this->isIndexedMode();
+	if (!this->allowIndexed) this->materialize();
 
-	case DisplayMode::plain:
-	default:
-		this->renderTime(buf);
-		this->set(buf, palette, true);
-		break;
+	// effects with a fixed interval only render when the next frame is due
+	if (effect->interval == 0 || (unsigned long)(millis() - this->lastUpdate) > effect->interval)
+	{
+		if (effect->interval != 0) this->lastUpdate = millis();
+		(this->*effect->render)();
 	}
 
+	// frame is complete, transfer it to the LEDs unless the previous one is still
+	// being sent
+	this->commit();
+	if (this->strip->CanShow()) this->show();
 
-	// transfer this->currentValues to LEDs
-	this->show();
+}
+
+//---------------------------------------------------------------------------------------
+// isIndexedMode
+//
+// Checks if the current mode only shows indexed frames without fading or direct
+// access to the RGB buffers
+//
+// -> --
+// <- true if the frames of the current mode can be kept in indexed form
+//---------------------------------------------------------------------------------------
+bool LEDFunctionsClass::isIndexedMode()
+{
+	const effect_descriptor *effect = LEDFunctionsClass::effect(this->mode);
+	if (effect == NULL) return false;
+	if (effect->flags & EFFECT_INDEXED)
+	{
+		// animations which fade to their frames need the RGB buffers
+		return !((effect->flags & EFFECT_ANIMATION) && this->state &&
+			this->state->animation.player->fades());
+	}
 
+	// these show the plain time in night mode
+	return (effect->flags & EFFECT_NIGHTPLAIN) && Config.nightmode;
 }
 
 //---------------------------------------------------------------------------------------
@@ -523,11 +521,10 @@ void LEDFunctionsClass::process()
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::setBrightness(int brightness)
 {
-  if (brightness>0) 	{
-    this->brightness = brightness;
-  }else {
-    this->brightness=1;
-  }
+  if (brightness<1) brightness=1;
+  if (brightness == this->brightness) return;
+  this->brightness = brightness;
+  this->updateCalibration();
 }
 
 //---------------------------------------------------------------------------------------
@@ -535,46 +532,37 @@ void LEDFunctionsClass::setBrightness(int brightness)
 //
 // Sets the display mode to one of the members of the DisplayMode enum and thus changes
 // what will be shown on the display during the next calls of LEDFunctionsClass.process()
+// If the mode changes, the previous effect is torn down and the new one initialized.
+// The last frame of the previous mode is kept for the configured transition, see
+// composeTransition().
 //
 // -> newMode: mode to be set
 // <- --
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::setMode(DisplayMode newMode)
 {
-	uint8_t buf[NUM_PIXELS];
-	DisplayMode previousMode = this->mode;
-	this->mode = newMode;
-
-	// if we changed to an animated letters mode, then start animation
-	// even if the current time did not yet change
-	if(newMode != previousMode &&
-			(newMode == DisplayMode::flyingLettersVerticalUp ||
-			newMode == DisplayMode::flyingLettersVerticalDown))
-	{
-		this->renderTime(buf);
-		this->prepareFlyingLetters(buf);
-	}
-
-	// if we changed to exploding letters mode, then start animation
-	// even if the current time did not yet change
-	if(newMode != previousMode && newMode == DisplayMode::explode)
-	{
-		// cleanup any existing particles to prevent memory leaks
-		for(Particle *p : this->particles) delete p;
-		this->particles.clear();
-		
-		this->renderTime(buf);
-		this->prepareExplosion(buf);
-	}
+	const effect_descriptor *next = LEDFunctionsClass::effect(newMode);
+	if (next == NULL || newMode == this->mode) return;
+
+	// stop the current effect and release its data
+	const effect_descriptor *previous = LEDFunctionsClass::effect(this->mode);
+	if (Config.transition != TransitionType::none && previous != NULL &&
+			!((previous->flags | next->flags) & EFFECT_NOTRANSITION))
+		this->startTransition();
+	else
+		this->stopTransition();
+	if (previous != NULL && previous->teardown != nullptr) (this->*previous->teardown)();
+	delete this->state;
+	this->state = nullptr;
 
-	// if we changed away from exploding letters mode, cleanup particles
-	if(previousMode == DisplayMode::explode && newMode != DisplayMode::explode)
+	// start the new effect
+	this->mode = newMode;
+	if (next->flags & EFFECT_STATE)
 	{
-		for(Particle *p : this->particles) delete p;
-		this->particles.clear();
+		this->state = new effect_state;
+		memset(this->state, 0, sizeof(effect_state));
 	}
-
-	// this->process();
+	if (next->init != nullptr) (this->*next->init)();
 }
 
 //---------------------------------------------------------------------------------------
@@ -612,25 +600,43 @@ void LEDFunctionsClass::set(const uint8_t *buf, palette_entry palette[])
 void LEDFunctionsClass::set(const uint8_t *buf, palette_entry palette[],
 		bool immediately)
 {
+  if (immediately && this->allowIndexed)
+  {
+    if (Config.nightmode) {
+      palette_entry nightpalette[] = {
+        {0, 0, 0},
+        {0, 0, (uint8_t)(2*(255/this->brightness))},
+        {0, 0, 0}
+      };
+      this->setIndexed(buf, nightpalette);
+    } else {
+      this->setIndexed(buf, palette);
+    }
+    return;
+  }
+
+  this->materialize();
+  bool changed;
   if (Config.nightmode) {
     palette_entry nightpalette[] = {
       {0, 0, 0},
       {0, 0, (uint8_t)(2*(255/this->brightness))},
       {0, 0, 0}
     };
-    this->setBuffer(this->targetValues, buf, nightpalette);
+    changed = this->setBuffer(this->targetValues, buf, nightpalette);
     if (immediately)
     {
       this->setBuffer(this->currentValues, buf, nightpalette);
     }
     
   } else {
-  	this->setBuffer(this->targetValues, buf, palette);
+  	changed = this->setBuffer(this->targetValues, buf, palette);
     if (immediately)
     {
   	  this->setBuffer(this->currentValues, buf, palette);
     }
   }
+  if (changed) this->startFade();
 }
 
 //---------------------------------------------------------------------------------------
@@ -643,12 +649,14 @@ void LEDFunctionsClass::set(const uint8_t *buf, palette_entry palette[],
 // -> target: color buffer, e. g. this->targetValues or this->currentValues
 //    source: buffer with color indexes
 //	  palette: colors for indexed source buffer
-// <- --
+// <- true if the content of target has changed
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::setBuffer(uint8_t *target, const uint8_t *source,
-		palette_entry palette[])
+bool LEDFunctionsClass::setBuffer(uint8_t *target, const uint8_t *source,
+		const palette_entry palette[])
 {
 	uint32_t mapping, palette_index, curveOffset;
+	uint8_t r, g, b;
+	bool changed = false;
 
 	// cast source to 32 bit pointer to ensure 32 bit aligned access
 	uint32_t *buf = (uint32_t*) source;
@@ -668,12 +676,69 @@ void LEDFunctionsClass::setBuffer(uint8_t *target, const uint8_t *source,
 		curveOffset = LEDFunctionsClass::brightnessCurveSelect[i] << 8;
 
 		// select color value using palette and brightness correction curves
-		target[mapping + 0] = brightnessCurvesR[curveOffset + palette[palette_index].r];
-		target[mapping + 1] = brightnessCurvesG[curveOffset + palette[palette_index].g];
-		target[mapping + 2] = brightnessCurvesB[curveOffset + palette[palette_index].b];
+		r = brightnessCurvesR[curveOffset + palette[palette_index].r];
+		g = brightnessCurvesG[curveOffset + palette[palette_index].g];
+		b = brightnessCurvesB[curveOffset + palette[palette_index].b];
+		changed |= target[mapping + 0] != r || target[mapping + 1] != g || target[mapping + 2] != b;
+		target[mapping + 0] = r;
+		target[mapping + 1] = g;
+		target[mapping + 2] = b;
 
 		byteCounter = (byteCounter + 1) & 0x03;
 	}
+	return changed;
+}
+
+//---------------------------------------------------------------------------------------
+// setIndexed
+//
+// Stores an indexed frame and its palette without expanding it to RGB. Palettes of up
+// to FRAME_PALETTE_SIZE used entries are copied (they usually live on the stack),
+// larger ones must be static. Same alignment rules as setBuffer().
+//
+// -> buf: indexed source buffer
+//	  palette: colors for indexed source buffer
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::setIndexed(const uint8_t *buf, const palette_entry palette[])
+{
+	const uint32_t *source = (const uint32_t*) buf;
+	uint32_t *target = (uint32_t*) this->indexValues;
+	uint8_t maxIndex = 0;
+
+	for (int i = 0; i < NUM_PIXELS_ALIGNED / 4; i++) target[i] = source[i];
+	for (int i = 0; i < NUM_PIXELS; i++)
+	{
+		if (this->indexValues[i] > maxIndex) maxIndex = this->indexValues[i];
+	}
+
+	if (maxIndex < FRAME_PALETTE_SIZE)
+	{
+		memcpy(this->framePalette, palette, (maxIndex + 1) * sizeof(palette_entry));
+		this->indexPalette = this->framePalette;
+	}
+	else
+	{
+		this->indexPalette = palette;
+	}
+	this->indexed = true;
+}
+
+//---------------------------------------------------------------------------------------
+// materialize
+//
+// Expands a pending indexed frame into this->currentValues and this->targetValues, must
+// be called before the RGB buffers are accessed directly
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::materialize()
+{
+	if (!this->indexed) return;
+	this->setBuffer(this->currentValues, this->indexValues, this->indexPalette);
+	memcpy(this->targetValues, this->currentValues, sizeof(this->targetValues));
+	this->indexed = false;
 }
 
 //---------------------------------------------------------------------------------------
@@ -703,11 +768,26 @@ void LEDFunctionsClass::renderRandomDots()
     this->currentValues[RandomDot*3+2]=random(2)*255; 
 
     this->lastUpdate=millis();
+    this->startFade();
   }
   
   this->fade();
 }
 
+//---------------------------------------------------------------------------------------
+// initRandomStripes
+//
+// Starts the random line from the top left to the bottom right corner
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::initRandomStripes()
+{
+  this->state->line.x2 = 10;
+  this->state->line.y2 = 9;
+}
+
 //---------------------------------------------------------------------------------------
 // renderRandomStripes
 //
@@ -727,28 +807,29 @@ void LEDFunctionsClass::renderRandomStripes()
 
     palette_entry color = { (uint8_t)(random(2)*255), (uint8_t)(random(2)*255), (uint8_t)(random(2)*255) };
 
-    // this->drawLine(this->targetValues,this->X1,this->Y1,this->X2,this->Y2,Config.fg);
-    this->drawLine(this->targetValues,this->X1,this->Y1,this->X2,this->Y2,color);
+    // this->drawLine(this->targetValues,this->state->line.x1,this->state->line.y1,this->state->line.x2,this->state->line.y2,Config.fg);
+    this->drawLine(this->targetValues,this->state->line.x1,this->state->line.y1,this->state->line.x2,this->state->line.y2,color);
 
     // calculate next coords
-    this->X1+=random(3)-1;
-    if (this->X1<0) this->X1=0;
-    if (this->X1>10) this->X1=10;
+    this->state->line.x1+=random(3)-1;
+    if (this->state->line.x1<0) this->state->line.x1=0;
+    if (this->state->line.x1>10) this->state->line.x1=10;
 
-    this->X2+=random(3)-1;
-    if (this->X2<0) this->X2=0;
-    if (this->X2>10) this->X2=10;
+    this->state->line.x2+=random(3)-1;
+    if (this->state->line.x2<0) this->state->line.x2=0;
+    if (this->state->line.x2>10) this->state->line.x2=10;
 
-    this->Y1+=random(3)-1;
-    if (this->Y1<0) this->Y1=0;
-    if (this->Y1>9) this->Y1=9;
+    this->state->line.y1+=random(3)-1;
+    if (this->state->line.y1<0) this->state->line.y1=0;
+    if (this->state->line.y1>9) this->state->line.y1=9;
 
-    this->Y2+=random(3)-1;
-    if (this->Y2<0) this->Y2=0;
-    if (this->Y2>9) this->Y2=9;
+    this->state->line.y2+=random(3)-1;
+    if (this->state->line.y2<0) this->state->line.y2=0;
+    if (this->state->line.y2>9) this->state->line.y2=9;
 
 
     this->lastUpdate=millis();
+    this->startFade();
   }
   
   this->fade();
@@ -782,40 +863,41 @@ void LEDFunctionsClass::renderRotatingLine()
       {255, 255, 255}
     };
 
-    // this->drawLine(this->targetValues,this->X1,this->Y1,10-this->X1,9-this->Y1,Config.fg);
-    this->drawLine(this->targetValues,this->X1,this->Y1,10-this->X1,9-this->Y1,color[random(7)]);
+    // this->drawLine(this->targetValues,this->state->line.x1,this->state->line.y1,10-this->state->line.x1,9-this->state->line.y1,Config.fg);
+    this->drawLine(this->targetValues,this->state->line.x1,this->state->line.y1,10-this->state->line.x1,9-this->state->line.y1,color[random(7)]);
 
     // calculate next coords
-    if (this->Y1==0) {
+    if (this->state->line.y1==0) {
       // we are on top row
-      if (this->X1==10) {
+      if (this->state->line.x1==10) {
         // we are on top right corner
-        this->Y1++;
+        this->state->line.y1++;
       } else {
         // we are somewhere else on the top row
-        this->X1++;
+        this->state->line.x1++;
       }
-    } else if (this->Y1==9) {
+    } else if (this->state->line.y1==9) {
       // we are on bottom row
-      if (this->X1==0) {
+      if (this->state->line.x1==0) {
         // we are on bottom left corner
-        this->Y1--;
+        this->state->line.y1--;
       } else {
         // we are somewhere else on bottom row
-        this->X1--;
+        this->state->line.x1--;
       }
     } else {
       // we are either on left or right col
-      if (this->X1==0) {
+      if (this->state->line.x1==0) {
         // we are on left col
-        this->Y1--;
+        this->state->line.y1--;
       } else {
         // we are on tright col
-        this->Y1++;
+        this->state->line.y1++;
       }
     }
 
     this->lastUpdate=millis();
+    this->startFade();
   }
   
   this->fade();
@@ -823,17 +905,107 @@ void LEDFunctionsClass::renderRotatingLine()
 
 
 
+//---------------------------------------------------------------------------------------
+// ease
+//
+// Applies the configured easing curve to the fade progress
+//
+// -> p: linear progress 0..65536
+// <- eased progress 0..65536
+//---------------------------------------------------------------------------------------
+static inline uint32_t ease(uint32_t p)
+{
+	if (Config.fadeEasing == FadeEasing::easeInOut)
+	{
+		// smoothstep 3p^2 - 2p^3
+		uint32_t p2 = ((uint64_t)p * p) >> 16;
+		return ((uint64_t)p2 * (3 * 65536 - 2 * p)) >> 16;
+	}
+	return p;
+}
+
+//---------------------------------------------------------------------------------------
+// startFade
+//
+// Starts a new fade from this->currentValues to this->targetValues, must be called
+// whenever the target (or the current frame) has been changed
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::startFade()
+{
+	this->fadeStart = millis();
+	this->fadeEased = 0;
+}
+
 //---------------------------------------------------------------------------------------
 // fade
 //
+// Fades the color values from this->currentValues[i] to this->targetValues[i] within
+// Config.fadeDuration, following the configured easing curve. The step is derived from
+// the elapsed time, so the result does not depend on how often fade() is called.
+//
+// Each call moves the remaining distance by (e(now) - e(before)) / (1 - e(before)),
+// which keeps every channel on the curve start + (target - start) * e(t) without
+// storing the start frame, and lands exactly on the target at the end. Values written
+// directly to this->currentValues simply become the new starting point.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::fade()
+{
+	if (Config.fadeEasing == FadeEasing::stepped)
+	{
+		this->fadeStepped();
+		return;
+	}
+	if (this->fadeEased >= 65536) return;
+
+	unsigned long elapsed = millis() - this->fadeStart;
+	uint32_t p = elapsed >= (unsigned long)Config.fadeDuration ? 65536 :
+		(elapsed << 16) / Config.fadeDuration;
+	uint32_t e = ease(p);
+	if (e <= this->fadeEased) return;
+
+	// fraction of the remaining distance to move in this frame, 0..65536
+	int32_t f = ((uint64_t)(e - this->fadeEased) << 16) / (65536 - this->fadeEased);
+	this->fadeEased = e;
+
+	if (Config.fadeEasing == FadeEasing::gamma)
+	{
+		// interpolate in linear light instead of the encoded color values, the tables
+		// round trip exactly so f = 65536 lands on the target
+		for (int i = 0; i < NUM_PIXELS * 3; i++)
+		{
+			int32_t c = gammaDecode(this->currentValues[i]);
+			int32_t t = gammaDecode(this->targetValues[i]);
+			c += ((t - c) * (f >> 4) + 0x800) >> 12;
+			this->currentValues[i] = gammaEncode(c);
+		}
+		return;
+	}
+
+	for (int i = 0; i < NUM_PIXELS * 3; i++)
+	{
+		int32_t c = this->currentValues[i];
+		c += ((this->targetValues[i] - c) * f + 0x8000) >> 16;
+		this->currentValues[i] = c;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// fadeStepped
+//
 // Fade one step of the color values from this->currentValues[i] to 
 // this->targetValues[i]. Uses non-linear fade speed depending on distance to target
-// value.
+// value. Works on four color values per 32 bit word (see fadeStep()).
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::fade()
+void LEDFunctionsClass::fadeStepped()
 {
   if ((unsigned long)(millis() - this->lastFadeTick) >= FADEINTERVAL) 
   {
@@ -844,103 +1016,282 @@ void LEDFunctionsClass::fade()
   	prescaler = 0;
   
   
-  	int delta;
-  	for (int i = 0; i < NUM_PIXELS * 3; i++)
-  	{
-  		delta = this->targetValues[i] - this->currentValues[i];
-      if (delta > 128) this->currentValues[i] += 32;
-      else if (delta > 64) this->currentValues[i] += 16;
-      else if (delta > 16) this->currentValues[i] += 8;
-  		else if (delta > 0) this->currentValues[i]++;
-      else if (delta < -128) this->currentValues[i] -= 32;
-  		else if (delta < -64) this->currentValues[i] -= 16;
-  		else if (delta < -16) this->currentValues[i] -= 8;
-  		else if (delta < 0) this->currentValues[i]--;
-  	}
+  	fadeStep(this->currentValues, this->targetValues, NUM_PIXELS * 3);
   }
 }
 
 //---------------------------------------------------------------------------------------
-// show
+// commit
 //
-// Internal method, copies this->currentValues to WS2812 object while applying brightness
+// Marks the current frame as complete by copying it to the front buffer, indexed
+// frames are expanded to RGB on the way
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::show()
+void LEDFunctionsClass::commit()
 {
-	uint8_t *data = this->currentValues;
-	int ofs = 0;
-
-	// copy current color values to LED object and display it
-	for (int i = 0; i < NUM_PIXELS; i++)
-	{
-  this->strip->SetPixelColor(i,RgbColor(((int) data[ofs + 0] * this->brightness) >> 8,
-                                        ((int) data[ofs + 1] * this->brightness) >> 8,  
-                                        ((int) data[ofs + 2] * this->brightness) >> 8));
-    ofs += 3;
-	}
-  this->strip->Show();
+	if (this->indexed)
+		this->setBuffer(this->frontValues, this->indexValues, this->indexPalette);
+	else
+		memcpy(this->frontValues, this->currentValues, sizeof(this->frontValues));
+	if (this->transitionFrom != nullptr) this->composeTransition();
 }
 
 //---------------------------------------------------------------------------------------
-// getOffset
+// startTransition
 //
-// Calculates the offset of a given RGB triplet inside the LED buffer.
-// Does range checking for x and y, uses the internal mapping table.
+// Keeps the frame on the display as the start of a transition to the next mode. If a
+// transition is already running, it continues from the mix currently shown.
 //
-// -> x: x coordinate
-//    y: y coordinate
-// <- offset for given coordinates
+// -> --
+// <- --
 //---------------------------------------------------------------------------------------
-int LEDFunctionsClass::getOffset(int x, int y)
+void LEDFunctionsClass::startTransition()
 {
-	if (x>=0 && y>=0 && x<LEDFunctionsClass::width && y<LEDFunctionsClass::height)
-	{
-		return LEDFunctionsClass::mapping[x + y*LEDFunctionsClass::width] * 3;
-	}
-	else
-	{
-		return 0;
-	}
+	if (this->transitionFrom == nullptr) this->transitionFrom = new uint8_t[NUM_PIXELS * 3];
+	memcpy(this->transitionFrom, this->frontValues, NUM_PIXELS * 3);
+	this->transitionStart = millis();
 }
 
 //---------------------------------------------------------------------------------------
-// fillBackground
+// stopTransition
 //
-// Initializes the buffer with either background (=0) or seconds progress (=2),
-// part of the background will be illuminated with color 2 depending on current
-// seconds/milliseconds value, whole screen is backlit when seconds = 59
+// Ends the running transition and releases its frame
 //
-// -> seconds, milliseconds: Time value which the fill process will base on
-//    buf: destination buffer
+// -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::fillBackground(int seconds, int milliseconds, uint8_t *buf)
+void LEDFunctionsClass::stopTransition()
 {
-	int pos = (((seconds * 1000 + milliseconds) * 110) / 60000) + 1;
-	for (int i = 0; i < NUM_PIXELS; i++) buf[i] = (i < pos) ? 2 : 0;
+	delete[] this->transitionFrom;
+	this->transitionFrom = nullptr;
 }
 
 //---------------------------------------------------------------------------------------
-// fillTime
+// blendPixel
 //
-// Adds words and minutes to buffer), buffer needs to be initialized (e.g. by fillbackground)
+// Mixes one LED of two RGB frames
 //
-// -> seconds, milliseconds: Time value which the fill process will base on
-//    buf: destination buffer
+// -> target: RGB of the new frame, receives the result
+//    from: RGB of the old frame
+//    w: weight of the new frame, 0..256
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::fillTime(int h, int m, uint8_t *target)
+static inline void blendPixel(uint8_t *target, const uint8_t *from, uint32_t w)
 {
-  // set static LEDs
-  target[0] = 1; // H
-  target[1] = 1; // E
-  target[2] = 1; // T
-
-  target[4] = 1; // I
-  target[5] = 1; // S
+	for (int k = 0; k < 3; k++) target[k] = (from[k] * (256 - w) + target[k] * w) >> 8;
+}
+
+//---------------------------------------------------------------------------------------
+// composeTransition
+//
+// Mixes the committed frame of the new mode with the last frame of the previous mode
+// in one pass over this->frontValues. The progress follows the easing curve of the
+// fade, the transition ends after Config.transitionDuration.
+//
+//   crossfade: all LEDs blend at the same time, two color values per multiplication
+//   wipe:      a soft edge moves from the left to the right, the minute LEDs switch
+//              halfway
+//   dissolve:  every LED blends in quickly at its own pseudo random time
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::composeTransition()
+{
+	unsigned long elapsed = millis() - this->transitionStart;
+	if (elapsed >= (unsigned long)Config.transitionDuration)
+	{
+		this->stopTransition();
+		return;
+	}
+	uint32_t p = ease((elapsed << 16) / Config.transitionDuration) >> 8; // 0..256
+	const uint8_t *from = this->transitionFrom;
+
+	switch (Config.transition)
+	{
+	case TransitionType::crossfade:
+	{
+		uint32_t *target = (uint32_t*) this->frontValues;
+		const uint32_t *source = (const uint32_t*) from;
+		const int words = (NUM_PIXELS * 3) / 4;
+
+		// each 16 bit lane holds at most 255 * 256, so the sums do not carry over
+		for (int i = 0; i < words; i++)
+		{
+			uint32_t f = source[i], t = target[i];
+			target[i] = ((((f & 0x00FF00FFUL) * (256 - p) + (t & 0x00FF00FFUL) * p) >> 8) & 0x00FF00FFUL) |
+				((((f >> 8) & 0x00FF00FFUL) * (256 - p) + ((t >> 8) & 0x00FF00FFUL) * p) & 0xFF00FF00UL);
+		}
+		for (int i = words * 4; i < NUM_PIXELS * 3; i++)
+		{
+			this->frontValues[i] = (from[i] * (256 - p) + this->frontValues[i] * p) >> 8;
+		}
+		break;
+	}
+
+	case TransitionType::wipe:
+	{
+		// position of the edge in 1/256 columns, it starts left of column 0 and ends
+		// right of the last column
+		int32_t edge = p * (LEDFunctionsClass::width + 1);
+		for (int i = 0; i < NUM_PIXELS; i++)
+		{
+			int x = i < LEDFunctionsClass::width * LEDFunctionsClass::height ?
+				i % LEDFunctionsClass::width : LEDFunctionsClass::width / 2;
+			int32_t w = constrain(edge - x * 256, 0, 256);
+			int ofs = LEDFunctionsClass::mapping[i] * 3;
+			blendPixel(&this->frontValues[ofs], &from[ofs], w);
+		}
+		break;
+	}
+
+	case TransitionType::dissolve:
+	{
+		// every LED takes 1/8 of the duration to blend in, starting at a time taken
+		// from a multiplicative hash of its index
+		int32_t q = p * 288 >> 8;
+		for (int i = 0; i < NUM_PIXELS; i++)
+		{
+			int32_t start = (uint32_t)(i * 2654435761UL) >> 24;
+			int32_t w = constrain((q - start) * 8, 0, 256);
+			int ofs = LEDFunctionsClass::mapping[i] * 3;
+			blendPixel(&this->frontValues[ofs], &from[ofs], w);
+		}
+		break;
+	}
+
+	default:
+		this->stopTransition();
+		break;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// outputLevel
+//
+// Converts a scaled channel value to the value sent to the LED, optionally carrying
+// the lost fraction over to the next frame (see show())
+//
+// -> value: channel value * brightness, 0..65535 (is clamped)
+//    error: fraction carried from the previous frame, NULL to truncate
+// <- LED value 0..255
+//---------------------------------------------------------------------------------------
+static inline uint8_t outputLevel(int32_t value, uint8_t *error)
+{
+	if (value < 0) value = 0;
+	if (error != NULL)
+	{
+		value += *error;
+		*error = value;
+	}
+	value >>= 8;
+	return value > 255 ? 255 : value;
+}
+
+//---------------------------------------------------------------------------------------
+// show
+//
+// Copies the last committed frame to WS2812 object while applying brightness and the
+// per LED calibration (if loaded)
+//
+// With Config.dithering enabled, the fraction which is lost by scaling with the
+// brightness is kept per channel and added to the next output. Since show() is called
+// on every pass of the main loop whenever the DMA is idle, i.e. much more often than
+// frames change, a value between two output levels is shown as the matching mix of
+// both levels, which smoothes fades at low brightness.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::show()
+{
+	uint8_t *data = this->frontValues;
+	uint8_t *error = Config.dithering ? this->ditherError : NULL;
+	const calibration_channel *channel = this->calibrationChannels;
+	uint8_t out[3];
+	int ofs = 0;
+
+	// copy current color values to LED object and display it
+	for (int i = 0; i < NUM_PIXELS; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			int32_t value = data[ofs + k];
+			if (channel != NULL)
+			{
+				if (value) value = value * channel[ofs + k].scale + channel[ofs + k].offset;
+			}
+			else
+			{
+				value *= this->brightness;
+			}
+			out[k] = outputLevel(value, error != NULL ? &error[ofs + k] : NULL);
+		}
+		this->strip->SetPixelColor(i, RgbColor(out[0], out[1], out[2]));
+		ofs += 3;
+	}
+	this->strip->Show();
+}
+
+//---------------------------------------------------------------------------------------
+// getOffset
+//
+// Calculates the offset of a given RGB triplet inside the LED buffer.
+// Does range checking for x and y, uses the internal mapping table.
+//
+// -> x: x coordinate
+//    y: y coordinate
+// <- offset for given coordinates
+//---------------------------------------------------------------------------------------
+int LEDFunctionsClass::getOffset(int x, int y)
+{
+	if (x>=0 && y>=0 && x<LEDFunctionsClass::width && y<LEDFunctionsClass::height)
+	{
+		return LEDFunctionsClass::mapping[x + y*LEDFunctionsClass::width] * 3;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// fillBackground
+//
+// Initializes the buffer with either background (=0) or seconds progress (=2),
+// part of the background will be illuminated with color 2 depending on current
+// seconds/milliseconds value, whole screen is backlit when seconds = 59
+//
+// -> seconds, milliseconds: Time value which the fill process will base on
+//    buf: destination buffer
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::fillBackground(int seconds, int milliseconds, uint8_t *buf)
+{
+	int pos = (((seconds * 1000 + milliseconds) * 110) / 60000) + 1;
+	for (int i = 0; i < NUM_PIXELS; i++) buf[i] = (i < pos) ? 2 : 0;
+}
+
+//---------------------------------------------------------------------------------------
+// fillTime
+//
+// Adds words and minutes to buffer), buffer needs to be initialized (e.g. by fillbackground)
+//
+// -> seconds, milliseconds: Time value which the fill process will base on
+//    buf: destination buffer
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::fillTime(int h, int m, uint8_t *target)
+{
+  // set static LEDs
+  target[0] = 1; // H
+  target[1] = 1; // E
+  target[2] = 1; // T
+
+  target[4] = 1; // I
+  target[5] = 1; // S
 
   // minutes 1...4 for the corners
   for(int i=0; i<=((m%5)-1); i++) target[10 * 11 + i] = 1;
@@ -1048,12 +1399,13 @@ void LEDFunctionsClass::drawLine(uint8_t *target, int8_t x1, int8_t y1, int8_t x
 //
 // Loads internal buffers with random colors
 //
-// -> target: buffer to be filled
-//    noofcolors: number of colors to populate
+// -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::renderRandom(uint8_t *target)
+void LEDFunctionsClass::renderRandom()
 {
+    uint8_t target[NUM_PIXELS];
+
     // Use static palette to avoid stack overflow and update less frequently
     static palette_entry palette[32];
     static unsigned long lastPaletteUpdate = 0;
@@ -1146,6 +1498,75 @@ void LEDFunctionsClass::renderStripes(uint8_t *target, bool Horizontal)
 
 
 
+//---------------------------------------------------------------------------------------
+// renderHorizontalStripes
+//
+// Renders the stripes animation with horizontal stripes
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderHorizontalStripes()
+{
+  uint8_t buf[NUM_PIXELS];
+  this->renderStripes(buf, true);
+}
+
+//---------------------------------------------------------------------------------------
+// renderVerticalStripes
+//
+// Renders the stripes animation with vertical stripes
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderVerticalStripes()
+{
+  uint8_t buf[NUM_PIXELS];
+  this->renderStripes(buf, false);
+}
+
+//---------------------------------------------------------------------------------------
+// renderPlain
+//
+// Displays the current time immediately
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderPlain()
+{
+	palette_entry palette[] = {
+		{Config.bg.r, Config.bg.g, Config.bg.b},
+		{Config.fg.r, Config.fg.g, Config.fg.b},
+		{Config.s.r,  Config.s.g,  Config.s.b}};
+	uint8_t buf[NUM_PIXELS];
+
+	this->renderTime(buf);
+	this->set(buf, palette, true);
+}
+
+//---------------------------------------------------------------------------------------
+// renderFade
+//
+// Fades to the current time
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderFade()
+{
+	palette_entry palette[] = {
+		{Config.bg.r, Config.bg.g, Config.bg.b},
+		{Config.fg.r, Config.fg.g, Config.fg.b},
+		{Config.s.r,  Config.s.g,  Config.s.b}};
+	uint8_t buf[NUM_PIXELS];
+
+	this->renderTime(buf);
+	this->set(buf, palette, false);
+	this->fade();
+}
+
 //---------------------------------------------------------------------------------------
 // renderTime
 //
@@ -1161,9 +1582,9 @@ void LEDFunctionsClass::renderTime(uint8_t *target)
 	this->fillBackground(NTP.s, NTP.ms, target);
   this->fillTime(NTP.h, NTP.m, target);
 
-	// DEBUG
+	// print the frame once per minute
 	static int last_minutes = -1;
-	if(last_minutes != NTP.m)
+	if(Config.logLevel >= LOG_DEBUG && last_minutes != NTP.m)
 	{
 		last_minutes = NTP.m;
 		Serial.printf("h=%i, m=%i, s=%i\r\n", NTP.h, NTP.m, NTP.s);
@@ -1180,59 +1601,84 @@ void LEDFunctionsClass::renderTime(uint8_t *target)
 }
 
 //---------------------------------------------------------------------------------------
-// renderHourglass
+// initHourglass
 //
-// Immediately displays an animation step of the hourglass animation.
-// ATTENTION: Animation frames must start at 32 bit boundary each!
+// Opens the built-in hourglass animation. The green hourglass (shown during the short
+// wait-for-OTA window) uses green instead of yellow for palette color 3.
 //
-// -> animationStep: Number of current frame [0...HOURGLASS_ANIMATION_FRAMES]
-//    green: Flag to switch the palette color 3 to green instead of yellow (used in the
-//           second half of the hourglass animation to indicate the short wait-for-OTA
-//           window)
+// -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::renderHourglass(bool green)
+void LEDFunctionsClass::initHourglass()
 {
-  if ((unsigned long) (millis()-this->lastUpdate)>100)
-  {
-    this->lastUpdate=millis();
-    if (++this->hourglassState >= HOURGLASS_ANIMATION_FRAMES)
-      this->hourglassState = 0;
-  }
-  
-	// colors in palette: black, white, yellow
-	palette_entry p[] = {{0, 0, 0}, {255, 255, 255}, {255, 255, 0}, {255, 255, 0}};
-
-	// delete red component in palette entry 3 to make this color green
-	if(green) p[3].r = 0;
-
-	if (this->hourglassState >= HOURGLASS_ANIMATION_FRAMES) this->hourglassState = 0;
-	this->set(hourglass_animation[this->hourglassState], p, true);
+	AnimationPlayer *player = new AnimationPlayer();
+	player->open(hourglass_animation, sizeof(hourglass_animation));
+	if (this->mode == DisplayMode::greenHourglass) player->palette[3].r = 0;
+	this->state->animation.player = player;
 }
 
 //---------------------------------------------------------------------------------------
 // renderMatrix
 //
-// Renders one frame of the matrix animation and displays it immediately
+// Renders one frame of the matrix animation and displays it immediately. Each column
+// carries at most one falling drop. The drop head lights its cell at full intensity
+// when it enters a new row, all cells fade by the same factor every frame, so the
+// trail is left behind by the decay alone and a frame costs the same regardless of
+// the number of drops. Drop speed and decay follow Config.animspeed, the chance of a
+// new drop in an empty column follows Config.matrixDensity.
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::renderMatrix()
 {
-  // if ((unsigned long) (millis()-this->lastUpdate)>(unsigned)(100-Config.animspeed))
-  if ((unsigned long) (millis()-this->lastUpdate)>MATRIXINTERVAL)
-  {
-    this->lastUpdate=millis();
-  	// clear buffer
-  	memset(this->currentValues, 0, sizeof(this->currentValues));
-  
-  	// sort by y coordinate for correct overlapping
-  	std::sort(matrix.begin(), matrix.end());
-  
-  	// iterate over all matrix objects, move and render them
-  	for (MatrixObject &m : this->matrix) m.render(this->currentValues);
-  }
+	uint8_t *intensity = this->state->matrix.intensity;
+	uint32_t scale = Config.animspeed + 25; // 75 = normal speed
+	uint32_t fade = 256 - MATRIXFADE * scale / 75;
+
+	// move the drops, start new ones in empty columns
+	for (int x = 0; x < LEDFunctionsClass::width; x++)
+	{
+		int16_t &head = this->state->matrix.head[x];
+		uint8_t &speed = this->state->matrix.speed[x];
+		int y;
+
+		if (speed == 0)
+		{
+			if (random(2000) >= Config.matrixDensity) continue;
+			speed = MATRIXMINSPEED + random(MATRIXMAXSPEED - MATRIXMINSPEED);
+			head = 0;
+			y = 0;
+		}
+		else
+		{
+			y = (head >> 8) + 1;
+			head += speed * scale / 75;
+		}
+
+		// light every row the head entered during this frame
+		for (; y <= (head >> 8); y++)
+		{
+			if (y >= LEDFunctionsClass::height)
+			{
+				speed = 0;
+				break;
+			}
+			intensity[x + y * LEDFunctionsClass::width] = 255;
+		}
+	}
+
+	// fade all cells and convert them to colors: white head, green trail
+	memset(this->currentValues, 0, sizeof(this->currentValues));
+	for (int i = 0; i < LEDFunctionsClass::width * LEDFunctionsClass::height; i++)
+	{
+		uint8_t v = intensity[i];
+		if (v == 0) continue;
+		uint8_t *rgb = &this->currentValues[LEDFunctionsClass::mapping[i] * 3];
+		rgb[0] = rgb[2] = v >= 128 ? (v - 128) * 2 : 0;
+		rgb[1] = v >= 128 ? 255 : v * 2;
+		intensity[i] = v * fade >> 8;
+	}
 }
 
 const palette_entry LEDFunctionsClass::firePalette[256] = {
@@ -1305,75 +1751,170 @@ const palette_entry LEDFunctionsClass::plasmaPalette[256] = {
 };
 
 
-double _time = 0;
 void LEDFunctionsClass::renderPlasma()
 {
-  // if ((unsigned long) (millis()-this->lastUpdate)>(100-Config.animspeed)*2)
-  if ((unsigned long) (millis()-this->lastUpdate)>10)
-  {
-    this->lastUpdate=millis();
-    int color;
-    double cx, cy, xx, yy;
+  double &_time = this->state->plasma.time;
+  int color;
+  double cx, cy, xx, yy;
 
-    _time += 0.025;
+  _time += 0.025;
 
-    for (int y=0; y<LEDFunctionsClass::height; y++)
-    {
-        yy = (double)y / (double)LEDFunctionsClass::height / 3.0;
-        for (int x=0; x<LEDFunctionsClass::width; x++)
-        {
-            xx = (double)x / (double)LEDFunctionsClass::width / 3.0;
-            cx = xx + 0.5 * sin(_time / 5.0);
-            cy = (double)y/(double)LEDFunctionsClass::height / 3.0 + 0.5 * sin(_time / 3.0);
-            color = (
-            	sin(
-                    sqrt(100 * (cx*cx + cy*cy) + 1 + _time) +
-                    6.0 * (xx * sin(_time/2) + yy * cos(_time/3) + _time / 4.0)
-                ) + 1.0
+  for (int y=0; y<LEDFunctionsClass::height; y++)
+  {
+      yy = (double)y / (double)LEDFunctionsClass::height / 3.0;
+      for (int x=0; x<LEDFunctionsClass::width; x++)
+      {
+          xx = (double)x / (double)LEDFunctionsClass::width / 3.0;
+          cx = xx + 0.5 * sin(_time / 5.0);
+          cy = (double)y/(double)LEDFunctionsClass::height / 3.0 + 0.5 * sin(_time / 3.0);
+          color = (
+          	sin(
+                  sqrt(100 * (cx*cx + cy*cy) + 1 + _time) +
+                  6.0 * (xx * sin(_time/2) + yy * cos(_time/3) + _time / 4.0)
+              ) + 1.0
 			) * 128.0;
-            plasmaBuf[x + y * LEDFunctionsClass::width] = color;
-        }
-    }
-    this->set(plasmaBuf, (palette_entry*)plasmaPalette, true);
+          this->state->plasma.buf[x + y * LEDFunctionsClass::width] = color;
+      }
   }
+  this->set(this->state->plasma.buf, (palette_entry*)plasmaPalette, true);
 }
 
+//---------------------------------------------------------------------------------------
+// initFire
+//
+// Seeds the random generator of the fire effect
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::initFire()
+{
+	this->state->fire.rng = random(1, 0x7FFFFFFF);
+}
+
+//---------------------------------------------------------------------------------------
+// renderFire
+//
+// Renders one frame of the fire effect, see fireStep() in firekernel.cpp
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
 void LEDFunctionsClass::renderFire()
 {
-  if ((unsigned long) (millis()-this->lastUpdate)>FIREINTERVAL)
-  {
-    this->lastUpdate=millis();
-    int f;
+	static_assert(FIREWIND_MAX == FIRE_WINDSTEP, "fire wind setting must match the kernel");
+	static_assert(LEDFunctionsClass::width <= FIRE_MAXWIDTH, "matrix too wide for the fire kernel");
+	fireStep(this->state->fire.buf, LEDFunctionsClass::width, LEDFunctionsClass::height,
+		this->state->fire.rng, this->state->fire.windPhase,
+		Config.fireWind, Config.fireSparking, Config.fireCooling);
+	this->set(this->state->fire.buf, (palette_entry*)firePalette, true);
+}
 
-    // iterate over bottom row, create fire seed
-    for (int i = 0; i < LEDFunctionsClass::width; i++)
-    {
-        // only set hot spot with probability of 1/4
-        f = (random(4) == 0) ? random(256) : 0;
+//---------------------------------------------------------------------------------------
+// initAnimation
+//
+// Opens the animation file selected in the config
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::initAnimation()
+{
+	this->state->animation.player = new AnimationPlayer();
+	this->state->animation.player->open(Config.animationFile);
+	this->state->animation.serial = this->animationSerial;
+}
 
-        // update one pixel in bottom row
-        fireBuf[i + (LEDFunctionsClass::height - 1) * LEDFunctionsClass::width] = f;
-    }
+//---------------------------------------------------------------------------------------
+// reloadAnimation
+//
+// Makes DisplayMode::animation reopen the animation file, e. g. after it has been
+// uploaded again under the same name
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::reloadAnimation()
+{
+	this->animationSerial++;
+}
 
-    int y1, y2, l, r;
-    for (int y = 0; y < LEDFunctionsClass::height - 1; y++)
-    {
-        y1 = y + 1; if (y1 >= LEDFunctionsClass::height) y1 = LEDFunctionsClass::height - 1;
-        y2 = y + 2; if (y2 >= LEDFunctionsClass::height) y2 = LEDFunctionsClass::height - 1;
-        for (int x = 0; x < LEDFunctionsClass::width; x++)
-        {
-            l = x - 1; if (l < 0) l = 0;
-            r = x + 1; if (r >= LEDFunctionsClass::width) r = LEDFunctionsClass::width - 1;
-            fireBuf[x + y * LEDFunctionsClass::width] =
-                ((fireBuf[y1 * LEDFunctionsClass::width + l]
-                + fireBuf[y1 * LEDFunctionsClass::width + x]
-                + fireBuf[y1 * LEDFunctionsClass::width + r]
-                + fireBuf[y2 * LEDFunctionsClass::width + x])
-                * 32) / 129;
-        }
-    }
-    this->set(fireBuf, (palette_entry*)firePalette, true);
-  }
+//---------------------------------------------------------------------------------------
+// teardownAnimation
+//
+// Closes the animation file
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::teardownAnimation()
+{
+	delete this->state->animation.player;
+}
+
+//---------------------------------------------------------------------------------------
+// renderAnimation
+//
+// Shows the frames of the animation file selected in the config, see
+// animationplayer.cpp. Reopens the file if the config changes or reloadAnimation() was
+// called, shows the plain time if the file is missing or damaged.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderAnimation()
+{
+	AnimationPlayer *player = this->state->animation.player;
+
+	if (this->state->animation.serial != this->animationSerial || !player->isPath(Config.animationFile))
+	{
+		this->state->animation.serial = this->animationSerial;
+		player->open(Config.animationFile);
+		memset(this->state->animation.frame, 0, sizeof(this->state->animation.frame));
+		this->state->animation.duration = 0;
+	}
+	if (!player->isOpen())
+	{
+		this->renderPlain();
+		return;
+	}
+
+	this->playAnimation();
+}
+
+//---------------------------------------------------------------------------------------
+// playAnimation
+//
+// Shows the next frame of the animation in this->state->animation when its time has
+// come. Only the LEDs changed by the frame are written to the indexed frame. Animations
+// with ANIMATION_FADE fade to each frame, the fade continues on every call.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::playAnimation()
+{
+	AnimationPlayer *player = this->state->animation.player;
+
+	if (player->fades()) this->fade();
+	if ((unsigned long)(millis() - this->state->animation.lastFrame) < this->state->animation.duration) return;
+	this->state->animation.lastFrame = millis();
+	if (!player->nextFrame(this->state->animation.frame, this->state->animation.duration)) return;
+
+	this->set(this->state->animation.frame, player->palette, !player->fades());
+}
+
+//---------------------------------------------------------------------------------------
+// initStars
+//
+// Places the stars at random coordinates
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::initStars()
+{
+	for (StarObject &s : this->state->stars.star) s.randomize(this->state->stars.blocked);
 }
 
 //---------------------------------------------------------------------------------------
@@ -1392,7 +1933,7 @@ void LEDFunctionsClass::renderStars()
   	// clear buffer
   	memset(this->currentValues, 0, sizeof(this->currentValues));
   
-  	for(StarObject &s : this->stars) s.render(this->currentValues, this->stars);
+  	for(StarObject &s : this->state->stars.star) s.render(this->currentValues, this->state->stars.blocked);
   }
 }
 
@@ -1503,6 +2044,7 @@ void LEDFunctionsClass::renderChristmasTree()
       }
     }
     
+    this->startFade();
   }
   this->fade();
 }
@@ -1598,6 +2140,7 @@ void LEDFunctionsClass::renderJingleBells()
 				this->currentValues[ofs+2]=180;
 			}
 		}
+		this->startFade();
 	}
 	this->fade();
 }
@@ -1605,178 +2148,143 @@ void LEDFunctionsClass::renderJingleBells()
 //---------------------------------------------------------------------------------------
 // blendedColor
 //
-// calculates the correct in between color based on progress
+// calculates the correct in between color based on progress, blended in linear light
+// so the perceived brightness changes evenly
+//
+// -> from_color, to_color: colors to blend
+//    weight: 0..256, 0 = from_color, 256 = to_color
+// <- blended color
+//---------------------------------------------------------------------------------------
+palette_entry LEDFunctionsClass::blendedColor(palette_entry from_color, palette_entry to_color, uint32_t weight)
+{
+  palette_entry resulting_color = { gammaBlend(from_color.r, to_color.r, weight),
+                                    gammaBlend(from_color.g, to_color.g, weight),
+                                    gammaBlend(from_color.b, to_color.b, weight) };
+  return resulting_color;
+}
+
+//---------------------------------------------------------------------------------------
+// randomLetterColors
+//
+// Assigns one of three colors to each letter, neighbouring letters always differ
+//
+// -> colors: palette index 1..3 per letter
+//    count: number of letters
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::randomLetterColors(uint8_t *colors, int count)
+{
+	colors[0] = 1 + random(3);
+	for (int i = 1; i < count; i++)
+	{
+		// Avoid same color as previous letter
+		colors[i] = (colors[i-1] + random(2)) % 3 + 1;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// initText
+//
+// Creates the scrolling text of the greetings and notifications
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
-palette_entry LEDFunctionsClass::blendedColor(palette_entry from_color, palette_entry to_color, float progress)
+void LEDFunctionsClass::initText()
 {
-  palette_entry resulting_color = { (uint8_t)(from_color.r + progress*(to_color.r - from_color.r)), 
-                                    (uint8_t)(from_color.g + progress*(to_color.g - from_color.g)), 
-                                    (uint8_t)(from_color.b + progress*(to_color.b - from_color.b)) };  
-  return resulting_color;
+	this->state->text.scroll = new ScrollText();
 }
 
 //---------------------------------------------------------------------------------------
-// renderMerryChristmas
+// teardownText
 //
-// Renders "MERRY CHRISTMAS" scrolling horizontally with wrong sweater colors
-// (bright red, green, yellow) creating a festive ugly Christmas sweater effect
+// Deletes the scrolling text
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void LEDFunctionsClass::renderMerryChristmas()
+void LEDFunctionsClass::teardownText()
 {
-	// Linear mapping: animspeed 0->500ms, 100->40ms, then 5x faster for rockets
+	delete this->state->text.scroll;
+}
+
+//---------------------------------------------------------------------------------------
+// scrollDelay
+//
+// Returns the time between two scroll steps
+//
+// -> --
+// <- ms per column
+//---------------------------------------------------------------------------------------
+unsigned int LEDFunctionsClass::scrollDelay()
+{
+	// Linear mapping: animspeed 0->100ms, 100->10ms
 	unsigned int delay = (500 - (Config.animspeed * 460 / 100)) / 5;
 	if (delay < 10) delay = 10;
-  if ((unsigned long) (millis()-this->lastUpdate) > delay)
-  {
-    this->lastUpdate = millis();
-
-    // Clear all pixels
-    memset(this->currentValues, 0, sizeof(this->currentValues));
-    
-	// Per-item widths: sprite(21)+1 gap =22, letters 5+1=6
-	int letterWidths[20] = {22, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 22, 6};
-	bool isSprite[20] = {true,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,true,false};
-	int totalTextWidth = 0;
-	for (int i = 0; i < 20; i++) totalTextWidth += letterWidths[i];
-
-		// Total scroll length based on actual widths
-		// Add 11 pixels to scroll off screen + 5 pixels pause
-		int totalScrollLength = totalTextWidth + 11 + 5;
-
-		// Randomize colors at start (first entry) only once per cycle
-		if (!this->merryChristmasColorsInitialized || this->lastOffset == 0)
-		{
-			this->merryChristmasColors[0] = random(3);
-			for (int i = 1; i < 20; i++)
-			{
-				// Avoid same color as previous letter
-				this->merryChristmasColors[i] = (this->merryChristmasColors[i-1] + 1 + random(2)) % 3;
-			}
-			this->merryChristmasColorsInitialized = true;
-		}
-
-		// Update scroll offset
-		this->lastOffset++;
+	return delay;
+}
 
-		if (this->lastOffset > totalScrollLength)
-		{
-			this->lastOffset = 0;
-		}
-    
-	// Check if we're in the pause period (after text scrolled off)
-	if (this->lastOffset > totalTextWidth + 11)
-    {
-      // Pause period - keep screen dark
-      return;
-    }
-    
-		// Combined Santa + sleigh + reindeer sprite (21x10), RGB per pixel
-		static const uint8_t santaSleighSprite[10][21][3] PROGMEM = {
-		  { {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,255,255}, {  0,  0,  0}, {  0,  0,  0}},
-		  { {  0,  0,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,  0,  0}, {255,255,255}, {  0,  0,  0}},
-		  { {  0,  0,  0}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,255,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,  0,  0}, {255,  0,  0}, {255,255,255}},
-		  { {  0,  0,  0}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,255,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,255,213}, {255,255,213}, {255,255,255}, {255,255,255}},
-		  { {255,142, 71}, {255,142, 71}, {  0,  0,  0}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,255,  0}, {  0,  0,  0}, {142, 71,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {255,  0,  0}, {255,255,255}, {255,255,255}},
-		  { {  0,  0,  0}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {255,255,  0}, {255,255,  0}, {255,255,  0}, {255,255,  0}, {255,255,  0}, {255,255,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}, {255,  0,  0}, {255,  0,  0}, {255,  0,  0}},
-		  { {  0,  0,  0}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {255,142, 71}, {255,142, 71}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}, {255,  0,  0}, {255,  0,  0}, {142, 71,  0}},
-		  { {  0,  0,  0}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {255,142, 71}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}, {142, 71,  0}},
-		  { {  0,  0,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {  0,  0,  0}, {113, 57,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {213,213,213}, {213,213,213}, {213,213,213}, {213,213,213}, {213,213,213}, {213,213,213}},
-		  { {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {  0,  0,  0}, {213,213,213}, {213,213,213}, {213,213,213}, {213,213,213}, {213,213,213}, {213,213,213}}
-		};
+//---------------------------------------------------------------------------------------
+// renderMerryChristmas
+//
+// Renders "Merry Christmas" between two Santa sleighs scrolling horizontally with
+// wrong sweater colors (bright red, green, yellow) creating a festive ugly Christmas
+// sweater effect. The letters get new colors for each pass.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderMerryChristmas()
+{
+	// in nightmode, show the time instead of the christmas greeting
+	if (Config.nightmode)
+	{
+		this->renderPlain();
+		return;
+	}
 
-		// Sequence: sprite + space + "MERRY CHRISTMAS" + space + sprite + trailing gap
-		const uint8_t *letters[] = {
-			nullptr, LETTER_SPACE, LETTER_M_CAP, LETTER_e_LOW, LETTER_r_LOW, LETTER_r_LOW, LETTER_y_LOW, LETTER_SPACE,
-			LETTER_C_CAP, LETTER_h_LOW, LETTER_r_LOW, LETTER_i_LOW, LETTER_s_LOW, LETTER_t_LOW, LETTER_m_LOW, LETTER_a_LOW, LETTER_s_LOW, LETTER_SPACE,
-			nullptr, LETTER_SPACE
-		};
-		int numLetters = 20;
-    
-    // For each Y row (0-9)
-    for (int y = 0; y < 10; y++)
-    {
-      // For each X position on screen (0-10)
-      for (int x = 0; x < 11; x++)
-      {
-				// Calculate position in scrolling text
-				int scrollPos = (x + this->lastOffset - 11);
-        
-				// Skip if out of bounds
-				if (scrollPos < 0 || scrollPos >= totalTextWidth) continue;
-        
-				// Determine letter index and position using variable widths
-				int accum = 0;
-				int letterIndex = -1;
-				int posInLetter = -1;
-				for (int i = 0; i < numLetters; i++)
-				{
-					int w = letterWidths[i];
-					if (scrollPos >= accum && scrollPos < accum + w)
-					{
-						letterIndex = i;
-						posInLetter = scrollPos - accum;
-						break;
-					}
-					accum += w;
-				}
-				if (letterIndex < 0) continue;
+	if ((unsigned long)(millis() - this->lastUpdate) <= this->scrollDelay()) return;
+	this->lastUpdate = millis();
 
-				bool pixelOn = false;
-				uint8_t r = 0, g = 0, b = 0;
+	static const char greeting[] = " Merry Christmas ";
+	ScrollText *scroll = this->state->text.scroll;
+	if (this->lastOffset == 0)
+	{
+		uint8_t colors[sizeof(greeting)];
+		LEDFunctionsClass::randomLetterColors(colors, sizeof(greeting) - 1);
+		scroll->clear();
+		scroll->addSprite(santaSleighSprite, 21);
+		scroll->addGap(1);
+		scroll->addText(greeting, colors, 0);
+		scroll->addSprite(santaSleighSprite, 21);
+		scroll->addGap(4);
+	}
 
-				int glyphWidth = isSprite[letterIndex] ? 21 : 5;
-				if (posInLetter >= glyphWidth) continue; // skip spacer column
+	// scroll through, off the screen and pause for 5 steps
+	this->lastOffset++;
+	if (this->lastOffset > scroll->length() + LEDFunctionsClass::width + 5) this->lastOffset = 0;
+	scroll->step(this->state->text.frame, LEDFunctionsClass::width, LEDFunctionsClass::height);
 
-				if (isSprite[letterIndex])
-				{
-					r = pgm_read_byte(&(santaSleighSprite[y][posInLetter][0]));
-					g = pgm_read_byte(&(santaSleighSprite[y][posInLetter][1]));
-					b = pgm_read_byte(&(santaSleighSprite[y][posInLetter][2]));
-					pixelOn = (r != 0 || g != 0 || b != 0);
-				}
-				else
-				{
-					uint8_t pattern = letters[letterIndex][y];
-					int bitPos = 4 - posInLetter;
-					pixelOn = (pattern & (1 << bitPos)) != 0;
-					if (pixelOn)
-					{
-						int colorPhase = this->merryChristmasColors[letterIndex];
-						if (colorPhase == 0)
-						{
-							r = 255; g = 0; b = 0;      // Red
-						}
-						else if (colorPhase == 1)
-						{
-							r = 0; g = 255; b = 0;      // Green
-						}
-						else
-						{
-							r = 255; g = 220; b = 0;    // Yellow
-						}
-					}
-				}
+	palette_entry palette[] = {
+		{0, 0, 0}, {255, 0, 0}, {0, 255, 0}, {255, 220, 0},
+		// sprite colors
+		{255, 142, 71}, {113, 57, 0}, {255, 255, 0}, {142, 71, 0},
+		{213, 213, 213}, {255, 255, 213}, {255, 255, 255}};
+	this->set(this->state->text.frame, palette, true);
+}
 
-				if (pixelOn)
-				{
-					int mappedIndex = LEDFunctionsClass::mapping[y * 11 + x] * 3;
-					this->currentValues[mappedIndex] = r;
-					this->currentValues[mappedIndex + 1] = g;
-					this->currentValues[mappedIndex + 2] = b;
-				}
-      }
-    }
-    
-    // Keep corner LEDs (110-113) off - they are already cleared by memset
-  }
-  
-  // this->fade();
+//---------------------------------------------------------------------------------------
+// teardownHappyNewYear
+//
+// Deletes the fireworks and the scrolling text
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::teardownHappyNewYear()
+{
+	this->teardownParticles();
+	this->teardownText();
 }
 
 //---------------------------------------------------------------------------------------
@@ -1790,6 +2298,13 @@ void LEDFunctionsClass::renderMerryChristmas()
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::renderHappyNewYear()
 {
+  // in nightmode, show the time instead of the new year greeting
+  if (Config.nightmode)
+  {
+    this->renderPlain();
+    return;
+  }
+
   // Linear mapping: animspeed 0->500ms, 100->40ms
   unsigned int delay = 500 - (Config.animspeed * 460 / 100);
   if ((unsigned long) (millis()-this->lastUpdate) > delay)
@@ -1806,25 +2321,20 @@ void LEDFunctionsClass::renderHappyNewYear()
 	// Calculate cycle lengths
 	int fireworksDuration = 120;
     
-    // Letter widths for "Happy New Year": H=6, a=6, p=6, p=6, y=6, space=6, N=6, e=6, w=6, space=6, Y=6, e=6, a=6, r=6
-    int letterWidths[14] = {6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6};
-    int totalTextWidth = 0;
-    for (int i = 0; i < 14; i++) totalTextWidth += letterWidths[i];
-    int totalScrollLength = totalTextWidth + 11 + 5; // Text + scroll off + pause
-    
-		int totalCycleLength = fireworksDuration + totalScrollLength;
-
-		// Randomize colors at start of cycle (first run) only once per cycle
-		if (!this->happyNewYearColorsInitialized || this->lastOffset == 0)
+		// Build the text with new colors once per cycle
+		static const char greeting[] = "Happy New Year";
+		ScrollText *scroll = this->state->text.scroll;
+		if (this->lastOffset == 0)
 		{
-			this->happyNewYearColors[0] = random(3);
-			for (int i = 1; i < 14; i++)
-			{
-				this->happyNewYearColors[i] = (this->happyNewYearColors[i-1] + 1 + random(2)) % 3;
-			}
-			this->happyNewYearColorsInitialized = true;
+			uint8_t colors[sizeof(greeting)];
+			LEDFunctionsClass::randomLetterColors(colors, sizeof(greeting) - 1);
+			scroll->clear();
+			scroll->addText(greeting, colors, 0);
 		}
 
+		int totalScrollLength = scroll->length() + 11 + 5; // Text + scroll off + pause
+		int totalCycleLength = fireworksDuration + totalScrollLength;
+
 		// Advance offset
 		this->lastOffset++;
 
@@ -1997,91 +2507,91 @@ void LEDFunctionsClass::renderHappyNewYear()
         this->particles.clear();
       }
     }
-    // Text phase: "Happy New Year" with mixed case
+    // Text phase: "Happy New Year" with mixed case, scrolls off and stays dark
+    // during the pause
     else
     {
-      int textOffset = this->lastOffset - fireworksDuration;
-      
-      // Check if we're in the pause period
-      if (textOffset > totalTextWidth + 11)
-      {
-        // Pause period - keep screen dark
-        return;
-      }
-      
-      // Happy New Year: H(cap) a(low) p(low) p(low) y(low) space N(cap) e(low) w(low) space Y(cap) e(low) a(low) r(low)
-      const uint8_t *letters[] = {
-        LETTER_H_CAP, LETTER_a_LOW, LETTER_p_LOW, LETTER_p_LOW, LETTER_y_LOW, LETTER_SPACE,
-        LETTER_N_CAP, LETTER_e_LOW, LETTER_w_LOW, LETTER_SPACE,
-        LETTER_Y_CAP, LETTER_e_LOW, LETTER_a_LOW, LETTER_r_LOW
-      };
-      int numLetters = 14;
-      
-      // For each Y row (0-9)
-      for (int y = 0; y < 10; y++)
-      {
-        // For each X position on screen (0-10)
-        for (int x = 0; x < 11; x++)
-        {
-          // Calculate position in scrolling text
-          int scrollPos = (x + textOffset - 11);
-          
-          // Skip if out of bounds
-          if (scrollPos < 0 || scrollPos >= totalTextWidth) continue;
-          
-          // Determine letter index and position
-          int accum = 0;
-          int letterIndex = -1;
-          int posInLetter = -1;
-          for (int i = 0; i < numLetters; i++)
-          {
-            int w = letterWidths[i];
-            if (scrollPos >= accum && scrollPos < accum + w)
-            {
-              letterIndex = i;
-              posInLetter = scrollPos - accum;
-              break;
-            }
-            accum += w;
-          }
-          if (letterIndex < 0) continue;
-          
-          int glyphWidth = 5;
-          if (posInLetter >= glyphWidth) continue; // skip spacer column
-          
-          uint8_t pattern = letters[letterIndex][y];
-          int bitPos = 4 - posInLetter;
-          bool pixelOn = (pattern & (1 << bitPos)) != 0;
-          
-          if (pixelOn)
-          {
-            uint8_t r, g, b;
-            int colorPhase = this->happyNewYearColors[letterIndex];
-            if (colorPhase == 0)
-            {
-              r = 255; g = 0; b = 0;      // Red
-            }
-            else if (colorPhase == 1)
-            {
-              r = 0; g = 255; b = 0;      // Green
-            }
-            else
-            {
-              r = 255; g = 220; b = 0;    // Yellow
-            }
-            
-            int mappedIndex = LEDFunctionsClass::mapping[y * 11 + x] * 3;
-            this->currentValues[mappedIndex] = r;
-            this->currentValues[mappedIndex + 1] = g;
-            this->currentValues[mappedIndex + 2] = b;
-          }
-        }
-      }
+      palette_entry palette[] = {{0, 0, 0}, {255, 0, 0}, {0, 255, 0}, {255, 220, 0}};
+      scroll->step(this->state->text.frame, LEDFunctionsClass::width, LEDFunctionsClass::height);
+      this->set(this->state->text.frame, palette, true);
     }
   }
 }
 
 
+//---------------------------------------------------------------------------------------
+// showText
+//
+// Scrolls a notification over the display. main.cpp switches to DisplayMode::scrollText
+// while isShowingText() is true.
+//
+// -> text: zero terminated text, longer texts are cut off
+//    color: color of the text
+//    repeat: number of passes
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::showText(const char *text, palette_entry color, int repeat)
+{
+	strncpy(this->text, text, TEXTSIZE - 1);
+	this->text[TEXTSIZE - 1] = 0;
+	this->textColor = color;
+	this->textRepeat = repeat;
+	this->textSerial++;
+}
+
+//---------------------------------------------------------------------------------------
+// isShowingText
+//
+// Checks if a notification is waiting to be shown or being shown
+//
+// -> --
+// <- true if passes of the notification are left
+//---------------------------------------------------------------------------------------
+bool LEDFunctionsClass::isShowingText()
+{
+	return this->textRepeat > 0 && this->text[0] != 0;
+}
+
+//---------------------------------------------------------------------------------------
+// renderText
+//
+// Scrolls the notification set by showText() one column per step. Starts over if a
+// new notification arrives, shows the plain time when all passes are done.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::renderText()
+{
+	// notifications wait until the end of the night
+	if (Config.nightmode || !this->isShowingText())
+	{
+		this->renderPlain();
+		return;
+	}
+
+	if ((unsigned long)(millis() - this->lastUpdate) <= this->scrollDelay()) return;
+	this->lastUpdate = millis();
+
+	ScrollText *scroll = this->state->text.scroll;
+	if (this->state->text.serial != this->textSerial || scroll->length() == 0)
+	{
+		this->state->text.serial = this->textSerial;
+		scroll->clear();
+		scroll->addText(this->text, nullptr, 1);
+		memset(this->state->text.frame, 0, sizeof(this->state->text.frame));
+	}
+
+	if (!scroll->step(this->state->text.frame, LEDFunctionsClass::width, LEDFunctionsClass::height))
+	{
+		this->textRepeat--;
+		scroll->rewind();
+	}
+
+	palette_entry palette[] = {{0, 0, 0}, this->textColor};
+	this->set(this->state->text.frame, palette, true);
+}
+
 //---------------------------------------------------------------------------------------
 // renderWakeup
 //
@@ -2127,21 +2637,26 @@ void LEDFunctionsClass::renderWakeup()
   palette_entry AirColor3 = {120, 175, 255}; // at 100%: LEt it be yellow, close to white */ // needs more thinking
 #endif
   
-  if (this->AlarmProgress<=0.3333){
+  // progress 0..768, three segments of 256 steps each
+  int progress = (int)(this->AlarmProgress * 768);
+  if (progress < 0) progress = 0;
+  if (progress > 768) progress = 768;
+
+  if (progress <= 256){
 #ifdef USE_SUN
-    palette[0] = this->blendedColor(AirColor0,AirColor1,this->AlarmProgress*3);
+    palette[0] = this->blendedColor(AirColor0,AirColor1,progress);
 #endif
-    palette[2] = this->blendedColor(SunColor0,SunColor1,this->AlarmProgress*3);
-  } else if (this->AlarmProgress<=0.666) {
+    palette[2] = this->blendedColor(SunColor0,SunColor1,progress);
+  } else if (progress <= 512) {
 #ifdef USE_SUN
-    palette[0] = this->blendedColor(AirColor1,AirColor2,(this->AlarmProgress-0.3333)*3);
+    palette[0] = this->blendedColor(AirColor1,AirColor2,progress-256);
 #endif
-    palette[2] = this->blendedColor(SunColor1,SunColor2,(this->AlarmProgress-0.3333)*3);
+    palette[2] = this->blendedColor(SunColor1,SunColor2,progress-256);
   } else {
 #ifdef USE_SUN
-    palette[0] = this->blendedColor(AirColor2,AirColor3,(this->AlarmProgress-0.6666)*3);
+    palette[0] = this->blendedColor(AirColor2,AirColor3,progress-512);
 #endif
-    palette[2] = this->blendedColor(SunColor2,SunColor3,(this->AlarmProgress-0.6666)*3);
+    palette[2] = this->blendedColor(SunColor2,SunColor3,progress-512);
   }
 
   // set the other colors
@@ -2164,55 +2679,50 @@ void LEDFunctionsClass::renderWakeup()
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::renderHeart()
 {
-//   if ((unsigned long) (millis()-this->lastUpdate)>(unsigned)(100-Config.animspeed))
-  if ((unsigned long) (millis()-this->lastUpdate)>RENDERHEARTINTERVAL)
-  {
-    this->lastUpdate=millis();
-  	palette_entry palette[2];
-  	uint8_t heart[] = {
-  		0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0,
-  		1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1,
-  		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-  		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-  		0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
-  		0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0,
-  		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
-  		0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0,
-  		0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
-  		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-  		1, 1, 1, 1
-  	};
-  	palette[0] = {0, 0, 0};
-  	palette[1] = {(uint8_t)this->heartBrightness, 0, 0};
-  	this->set(heart, palette, true);
-  
-  	switch (this->heartState)
-  	{
-  	case 0:
-  		if (this->heartBrightness >= 255) this->heartState = 1;
-  		else this->heartBrightness += 32;
-  		break;
-  
-  	case 1:
-  		if (this->heartBrightness < 128) this->heartState = 2;
-  		else this->heartBrightness -= 32;
-  		break;
-  
-  	case 2:
-  		if (this->heartBrightness >= 255) this->heartState = 3;
-  		else this->heartBrightness += 32;
-  		break;
-  
-  	case 3:
-  	default:
-  		if (this->heartBrightness <= 0) this->heartState = 0;
-  		else this->heartBrightness -= 4;
-  		break;
-  	}
-  
-  	if (this->heartBrightness > 255) this->heartBrightness = 255;
-  	if (this->heartBrightness < 0) this->heartBrightness = 0;  
-  }
+	palette_entry palette[2];
+	uint8_t heart[] = {
+		0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0,
+		1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+		0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
+		0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0,
+		0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0,
+		0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		1, 1, 1, 1
+	};
+	palette[0] = {0, 0, 0};
+	palette[1] = {(uint8_t)this->state->heart.brightness, 0, 0};
+	this->set(heart, palette, true);
+
+	switch (this->state->heart.state)
+	{
+	case 0:
+		if (this->state->heart.brightness >= 255) this->state->heart.state = 1;
+		else this->state->heart.brightness += 32;
+		break;
+
+	case 1:
+		if (this->state->heart.brightness < 128) this->state->heart.state = 2;
+		else this->state->heart.brightness -= 32;
+		break;
+
+	case 2:
+		if (this->state->heart.brightness >= 255) this->state->heart.state = 3;
+		else this->state->heart.brightness += 32;
+		break;
+
+	case 3:
+	default:
+		if (this->state->heart.brightness <= 0) this->state->heart.state = 0;
+		else this->state->heart.brightness -= 4;
+		break;
+	}
+
+	if (this->state->heart.brightness > 255) this->state->heart.brightness = 255;
+	if (this->state->heart.brightness < 0) this->state->heart.brightness = 0;
 }
 
 //---------------------------------------------------------------------------------------
@@ -2273,6 +2783,38 @@ void LEDFunctionsClass::prepareExplosion(uint8_t *source)
 	}
 }
 
+//---------------------------------------------------------------------------------------
+// initExplosion
+//
+// Starts the explosion of the current time even if it did not yet change
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::initExplosion()
+{
+	uint8_t buf[NUM_PIXELS];
+
+	this->teardownParticles();
+	this->renderTime(buf);
+	this->prepareExplosion(buf);
+}
+
+//---------------------------------------------------------------------------------------
+// teardownParticles
+//
+// Deletes all particles (exploding letters and new year fireworks)
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::teardownParticles()
+{
+	for(Particle *p : this->particles) delete p;
+	this->particles.clear();
+	this->particles.shrink_to_fit();
+}
+
 //---------------------------------------------------------------------------------------
 // renderExplosion
 //
@@ -2283,63 +2825,58 @@ void LEDFunctionsClass::prepareExplosion(uint8_t *source)
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::renderExplosion()
 {
-  // if ((unsigned long) (millis()-this->lastUpdate)>(unsigned)(100-Config.animspeed))
-  if ((unsigned long) (millis()-this->lastUpdate)>EXPLODEINTERVAL)
-  {
-    this->lastUpdate=millis();
-  	std::vector<Particle*> particlesToKeep;
-  	uint8_t buf[NUM_PIXELS];
-  
-  	// load palette colors from configuration
-  	palette_entry palette[] = {
-  		{Config.bg.r, Config.bg.g, Config.bg.b},
-  		{Config.fg.r, Config.fg.g, Config.fg.b},
-  		{Config.s.r,  Config.s.g,  Config.s.b}};
-  
-  	// check if the displayed time has changed
-  	if((NTP.m/5 != this->lastM/5) || (NTP.h != this->lastH))
-  	{
-  		// prepare new animation with old time
-  		this->renderTime(buf);
-  		this->prepareExplosion(buf);
-  	}
-  
-  	this->lastM = NTP.m;
-  	this->lastH = NTP.h;
-  
-  	// create empty buffer filled with seconds color
-  	this->fillBackground(NTP.s, NTP.ms, buf);
-  
-  	// minutes 1...4 for the corners
-  	for(int i=0; i<=((NTP.m%5)-1); i++) buf[10 * 11 + i] = 1;
-  
-  	// Do we have something to explode?
-  	if(this->particles.size() > 0)
-  	{
-  		// transfer background created by fillBackground to target buffer
-  		this->set(buf, palette, true);
-  
-  		// iterate over all particles
-  		for(Particle *p : this->particles)
-  		{
-  			// move and render current particle
-  			p->render(this->currentValues, palette);
-  
-  			// if particle is still active, keep it; kill it otherwise
-  			if(p->alive) particlesToKeep.push_back(p); else delete p;
-  		}
-  
-  		// only keep active particles, discard the rest
-  		// -> use particlesToKeep as new list
-  		this->particles.swap(particlesToKeep);
-  	}
-  	else
-  	{
-  		// present the current time in boring mode with simple fading
-  		this->renderTime(buf);
-  		this->set(buf, palette, false);
-  		this->fade();
-  	}
+	std::vector<Particle*> particlesToKeep;
+	uint8_t buf[NUM_PIXELS];
+
+	// load palette colors from configuration
+	palette_entry palette[] = {
+		{Config.bg.r, Config.bg.g, Config.bg.b},
+		{Config.fg.r, Config.fg.g, Config.fg.b},
+		{Config.s.r,  Config.s.g,  Config.s.b}};
+
+	// check if the displayed time has changed
+	if((NTP.m/5 != this->lastM/5) || (NTP.h != this->lastH))
+	{
+		// prepare new animation with old time
+		this->renderTime(buf);
+		this->prepareExplosion(buf);
+	}
+
+	this->lastM = NTP.m;
+	this->lastH = NTP.h;
+
+	// create empty buffer filled with seconds color
+	this->fillBackground(NTP.s, NTP.ms, buf);
+
+	// minutes 1...4 for the corners
+	for(int i=0; i<=((NTP.m%5)-1); i++) buf[10 * 11 + i] = 1;
+
+	// Do we have something to explode?
+	if(this->particles.size() > 0)
+	{
+		// transfer background created by fillBackground to target buffer
+		this->set(buf, palette, true);
+
+		// iterate over all particles
+		for(Particle *p : this->particles)
+		{
+			// move and render current particle
+			p->render(this->currentValues, palette);
+
+			// if particle is still active, keep it; kill it otherwise
+			if(p->alive) particlesToKeep.push_back(p); else delete p;
+		}
+
+		// only keep active particles, discard the rest
+		// -> use particlesToKeep as new list
+		this->particles.swap(particlesToKeep);
+	}
+	else
+	{
+		// present the current time in boring mode with simple fading
+		this->renderTime(buf);
+		this->set(buf, palette, false);
+		this->fade();
 	}
 }
 
@@ -2354,14 +2891,20 @@ void LEDFunctionsClass::renderExplosion()
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::prepareFlyingLetters(uint8_t *source)
 {
-	// transfer the previous flying letters in the leaving letters vector to prepare for
+	flying_letter *arriving = this->state->flyingLetters.arriving;
+	flying_letter *leaving = this->state->flyingLetters.leaving;
+	bool up = this->mode == DisplayMode::flyingLettersVerticalUp;
+
+	// transfer the previous flying letters to the leaving letters to prepare for
 	// outgoing animation
-	this->leavingLetters.clear();
-	for(xy_t &p : this->arrivingLetters)
+	this->state->flyingLetters.leavingCount = this->state->flyingLetters.arrivingCount;
+	for(int i=0; i<this->state->flyingLetters.arrivingCount; i++)
 	{
 		// delay every letter depending on its position
 		// and set new target coordinate
-		if(this->mode == DisplayMode::flyingLettersVerticalUp)
+		flying_letter &p = leaving[i];
+		p = arriving[i];
+		if(up)
 		{
 			p.delay = p.y * 2 + p.x + 1 + random(5);
 			p.yTarget = -1;
@@ -2371,11 +2914,10 @@ void LEDFunctionsClass::prepareFlyingLetters(uint8_t *source)
 			p.delay = (LEDFunctionsClass::height - p.y - 1) * 2 + p.x + 1 + random(5);
 			p.yTarget = LEDFunctionsClass::height;
 		}
-		this->leavingLetters.push_back(p);
 	}
 
 	// initialize arriving letters from scratch
-	this->arrivingLetters.clear();
+	int count = 0;
 	int ofs = 0;
 
 	// iterate over every position in the screen buffer
@@ -2383,46 +2925,99 @@ void LEDFunctionsClass::prepareFlyingLetters(uint8_t *source)
 	{
 		for(int x=0; x<LEDFunctionsClass::width; x++)
 		{
-			// create entry in arrivingLetters vector if current pixel is foreground
+			// create an arriving letter if current pixel is foreground
 			if(source[ofs++] == 1)
 			{
-				if(this->mode == DisplayMode::flyingLettersVerticalUp)
+				flying_letter &p = arriving[count++];
+				p.x = x;
+				p.yTarget = y;
+				p.counter = 0;
+				if(up)
 				{
-					xy_t p = {x, y, x, LEDFunctionsClass::height,
-							y * 2 + x + 1 + random(5), 200, 0};
-					this->arrivingLetters.push_back(p);
+					p.y = LEDFunctionsClass::height;
+					p.delay = y * 2 + x + 1 + random(5);
 				}
 				else
 				{
-					xy_t p = {x, y, x, -1,
-							(LEDFunctionsClass::height - y - 1) * 2 + x + 1 + random(5),
-							200, 0};
-					this->arrivingLetters.push_back(p);
+					p.y = -1;
+					p.delay = (LEDFunctionsClass::height - y - 1) * 2 + x + 1 + random(5);
 				}
 			}
 		}
 	}
+	this->state->flyingLetters.arrivingCount = count;
 
-	// DEBUG
-	Serial.printf("h=%i, m=%i, s=%i, lastH=%i, lastM=%i\r\n", NTP.h, NTP.m, NTP.s, this->lastH, this->lastM);
-	Serial.println("leavingLetters:");
-	for(xy_t &p : this->leavingLetters)
+	if(Config.logLevel >= LOG_DEBUG)
 	{
-		Serial.printf("  counter=%i, delay=%i, speed=%i, x=%i, y=%i, xTarget=%i, yTarget=%i\r\n",
-				p.counter, p.delay, p.speed, p.x, p.y, p.xTarget, p.yTarget);
+		Serial.printf("h=%i, m=%i, s=%i, lastH=%i, lastM=%i, leaving=%i, arriving=%i\r\n", NTP.h, NTP.m, NTP.s,
+				this->lastH, this->lastM, this->state->flyingLetters.leavingCount, count);
 	}
-	Serial.println("arrivingLetters:");
-	for(xy_t &p : this->arrivingLetters)
+}
+
+//---------------------------------------------------------------------------------------
+// initFlyingLetters
+//
+// Starts the animation with the current time even if it did not yet change
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void LEDFunctionsClass::initFlyingLetters()
+{
+	uint8_t buf[NUM_PIXELS];
+
+	this->renderTime(buf);
+	this->prepareFlyingLetters(buf);
+}
+
+//---------------------------------------------------------------------------------------
+// moveFlyingLetters
+//
+// Draws the letters and moves them one step towards their target
+//
+// -> letters: letters to move
+//    count: number of letters
+//    buf: indexed frame to draw to
+// <- number of letters which have not yet reached their target
+//---------------------------------------------------------------------------------------
+int LEDFunctionsClass::moveFlyingLetters(flying_letter *letters, int count, uint8_t *buf)
+{
+	int movedLetters = 0;
+
+	for(int i=0; i<count; i++)
 	{
-		Serial.printf("  counter=%i, delay=%i, speed=%i, x=%i, y=%i, xTarget=%i, yTarget=%i\r\n",
-				p.counter, p.delay, p.speed, p.x, p.y, p.xTarget, p.yTarget);
+		flying_letter &p = letters[i];
+
+		// draw letter only if inside visible area
+		if(p.y>=0 && p.y<LEDFunctionsClass::height)
+			buf[p.x + p.y * LEDFunctionsClass::width] = 1;
+
+		// continue with next letter if the current letter already
+		// reached its target position
+		if(p.y == p.yTarget) continue;
+		p.counter += FLYINGLETTERSSPEED;
+		movedLetters++;
+		if(p.counter >= 1000)
+		{
+			p.counter -= 1000;
+			if(p.delay>0)
+			{
+				// do not move if animation of current letter is delayed
+				p.delay--;
+			}
+			else
+			{
+				if(p.y > p.yTarget) p.y--; else p.y++;
+			}
+		}
 	}
+	return movedLetters;
 }
 
 //---------------------------------------------------------------------------------------
 // renderFlyingLetters
 //
-// Takes the current arrivingLetters and leavingLetters to render the flying letters
+// Takes the current arriving and leaving letters to render the flying letters
 // animation
 //
 // -> --
@@ -2430,104 +3025,48 @@ void LEDFunctionsClass::prepareFlyingLetters(uint8_t *source)
 //---------------------------------------------------------------------------------------
 void LEDFunctionsClass::renderFlyingLetters()
 {
-  // if ((unsigned long) (millis()-this->lastUpdate)>(unsigned)(100-Config.animspeed))
-  if ((unsigned long) (millis()-this->lastUpdate)>FLYINGLETTERSINTERVAL)
-  {
-    this->lastUpdate=millis();
-  	uint8_t buf[NUM_PIXELS];
-  
-  	// load palette colors from configuration
-  	palette_entry palette[] = {
-  		{Config.bg.r, Config.bg.g, Config.bg.b},
-  		{Config.fg.r, Config.fg.g, Config.fg.b},
-  		{Config.s.r,  Config.s.g,  Config.s.b}};
-  
-  	// check if the displayed time has changed
-  	if((NTP.m/5 != this->lastM/5) || (NTP.h != this->lastH))
-  	{
-  		// prepare new animation
-  		this->renderTime(buf);
-  		this->prepareFlyingLetters(buf);
-  	}
-  
-  	this->lastM = NTP.m;
-  	this->lastH = NTP.h;
-  
-  
-  	// create empty buffer filled with seconds color
-  	this->fillBackground(NTP.s, NTP.ms, buf);
-  
-  	// minutes 1...4 for the corners
-  	for(int i=0; i<=((NTP.m%5)-1); i++) buf[10 * 11 + i] = 1;
-  
-  	// leaving letters animation has priority
-  	if(this->leavingLetters.size() > 0)
-  	{
-  		// count actually moved letters to detect end of animation
-  		int movedLetters = 0;
-  
-  		// iterate over all leavingLetters
-  		for(xy_t &p : this->leavingLetters)
-  		{
-  			// draw letter only if inside visible area
-  			if(p.x>=0 && p.y>=0 && p.x<LEDFunctionsClass::width
-  					&& p.y<LEDFunctionsClass::height)
-  				buf[p.x + p.y * LEDFunctionsClass::width] = 1;
-  
-  			// continue with next letter if the current letter already
-  			// reached its target position
-  			if(p.y == p.yTarget && p.x == p.xTarget) continue;
-  			p.counter += p.speed;
-  			movedLetters++;
-  			if(p.counter >= 1000)
-  			{
-  				p.counter -= 1000;
-  				if(p.delay>0)
-  				{
-  					// do not move if animation of current letter is delayed
-  					p.delay--;
-  				}
-  				else
-  				{
-  					if(p.y > p.yTarget) p.y--; else p.y++;
-  				}
-  			}
-  		}
-  		if(movedLetters == 0) this->leavingLetters.clear();
-  	}
-  	else
-  	{
-  		// iterate over all arrivingLetters
-  		for(xy_t &p : this->arrivingLetters)
-  		{
-  			// draw letter only if inside visible area
-  			if(p.x>=0 && p.y>=0 && p.x<LEDFunctionsClass::width
-  					&& p.y<LEDFunctionsClass::height)
-  				buf[p.x + p.y * LEDFunctionsClass::width] = 1;
-  
-  			// continue with next letter if the current letter already
-  			// reached its target position
-  			if(p.y == p.yTarget && p.x == p.xTarget) continue;
-  			p.counter += p.speed;
-  			if(p.counter >= 1000)
-  			{
-  				p.counter -= 1000;
-  				if(p.delay>0)
-  				{
-  					// do not move if animation of current letter is delayed
-  					p.delay--;
-  				}
-  				else
-  				{
-  					if(p.y > p.yTarget) p.y--; else p.y++;
-  				}
-  			}
-  		}
-  	}
-  
-  	// present the current content immediately without fading
-  	this->set(buf, palette, true);
-  }
+	uint8_t buf[NUM_PIXELS];
+
+	// load palette colors from configuration
+	palette_entry palette[] = {
+		{Config.bg.r, Config.bg.g, Config.bg.b},
+		{Config.fg.r, Config.fg.g, Config.fg.b},
+		{Config.s.r,  Config.s.g,  Config.s.b}};
+
+	// check if the displayed time has changed
+	if((NTP.m/5 != this->lastM/5) || (NTP.h != this->lastH))
+	{
+		// prepare new animation
+		this->renderTime(buf);
+		this->prepareFlyingLetters(buf);
+	}
+
+	this->lastM = NTP.m;
+	this->lastH = NTP.h;
+
+
+	// create empty buffer filled with seconds color
+	this->fillBackground(NTP.s, NTP.ms, buf);
+
+	// minutes 1...4 for the corners
+	for(int i=0; i<=((NTP.m%5)-1); i++) buf[10 * 11 + i] = 1;
+
+	// leaving letters animation has priority, the arriving letters start when all
+	// leaving letters reached their target
+	if(this->state->flyingLetters.leavingCount > 0)
+	{
+		if(this->moveFlyingLetters(this->state->flyingLetters.leaving,
+				this->state->flyingLetters.leavingCount, buf) == 0)
+			this->state->flyingLetters.leavingCount = 0;
+	}
+	else
+	{
+		this->moveFlyingLetters(this->state->flyingLetters.arriving,
+				this->state->flyingLetters.arrivingCount, buf);
+	}
+
+	// present the current content immediately without fading
+	this->set(buf, palette, true);
 }
 
 //---------------------------------------------------------------------------------------
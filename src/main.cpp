@@ -35,10 +35,6 @@
 #include <ESP8266WebServer.h>
 #endif
 #include <ArduinoOTA.h>
-#include <Ticker.h>
-
-#include <DNSServer.h>
-#include <WiFiManager.h>
 
 #include "config.h"
 #include "ledfunctions.h"
@@ -47,6 +43,7 @@
 #include "iwebserver.h"
 // #include "osapi.h"
 #include "mqtt.h"
+#include "network.h"
 
 
 #define LED_RED		15
@@ -60,13 +57,14 @@
 // Network related variables
 //---------------------------------------------------------------------------------------
 int OTA_in_progress = 0;
+bool networkStarted = false;
 
 //---------------------------------------------------------------------------------------
 // Timer related variables
 //---------------------------------------------------------------------------------------
-#define TIMER_RESOLUTION 50
+#define TIMER_RESOLUTION 50 // ms between startup frames
 
-Ticker timer;
+unsigned long lastStartupFrame = 0;
 int lastSecond = -1;
 //---------------------------------------------------------------------------------------
 // Startup related variables
@@ -78,7 +76,7 @@ bool RecoverFromException = false;
 // int updateCountdown = 25;
 int updateCountdown = 0;
 
-bool NTPTimeAcquired=false;
+bool NTPTimeAcquired=false; // true if NTP or RTC memory provided a valid time
 
 //---------------------------------------------------------------------------------------
 // Loop logic related variables
@@ -102,36 +100,22 @@ unsigned long timestamp(int _h, int _m, int _s, int _ms)
 
 
 //---------------------------------------------------------------------------------------
-// timerCallback
+// renderPendingFrame
 //
-// Increments time, decrements timeout and NTP timer
+// Renders a frame if TIMER_RESOLUTION ms have passed since the last one. Called
+// between the (possibly slow) initialization steps, so the startup animation keeps
+// running while loop() is not yet active.
 //
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void timerCallback()
+void renderPendingFrame()
 {
-
+  if ((unsigned long)(millis() - lastStartupFrame) < TIMER_RESOLUTION) return;
+  lastStartupFrame = millis();
   if (startup && not RecoverFromException) LED.process();
 }
 
-//---------------------------------------------------------------------------------------
-// configModeCallback
-//
-// ...
-//
-// ->
-// <- --
-//---------------------------------------------------------------------------------------
-void configModeCallback(WiFiManager *myWiFiManager)
-{
-	LED.setMode(DisplayMode::wifiManager);
-  LED.process();
-	Serial.println("Entered config mode");
-	Serial.println(WiFi.softAPIP());
-	Serial.println(myWiFiManager->getConfigPortalSSID());
-}
-
 //---------------------------------------------------------------------------------------
 // NtpCallback
 //
@@ -157,6 +141,81 @@ void setLED(unsigned char r, unsigned char g, unsigned char b)
 	digitalWrite(LED_BLUE, b);
 }
 
+//---------------------------------------------------------------------------------------
+// startNetworkServices
+//
+// Is called by the network class on the first WiFi connection, starts OTA, NTP,
+// web server and MQTT
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void startNetworkServices()
+{
+  // keep rendering from renderPendingFrame() while the services start
+  startup = true;
+
+	setLED(0, 1, 0);
+
+	// OTA update
+	Serial.println("Initializing OTA");
+	ArduinoOTA.setPort(8266);
+	ArduinoOTA.setHostname(Config.hostname);
+	// ArduinoOTA.setPassword("WordClock");
+	ArduinoOTA.onStart([]()
+	{
+    MQTT.PublishStatus("offline");
+		LED.setMode(DisplayMode::update);
+		Config.updateProgress = 0;
+    Config.nightmode=false;
+		OTA_in_progress = 1;
+    LED.process();
+		Serial.println("OTA Start");
+	});
+	ArduinoOTA.onEnd([]()
+	{
+		LED.setMode(DisplayMode::updateComplete);
+    LED.process();
+		Serial.println("\nOTA End");
+	});
+	ArduinoOTA.onProgress([](unsigned int progress, unsigned int total)
+	{
+		LED.setMode(DisplayMode::update);
+		Config.updateProgress = (progress) * 110 / total;
+    LED.process();
+    Serial.printf("OTA Progress: %u%%\r\n", (progress / (total / 100)));
+	});
+	ArduinoOTA.onError([](ota_error_t error)
+	{
+		LED.setMode(DisplayMode::updateError);
+    LED.process();
+		Serial.printf("OTA Error[%u]: ", error);
+		if (error == OTA_AUTH_ERROR) Serial.println("Auth Failed");
+		else if (error == OTA_BEGIN_ERROR) Serial.println("Begin Failed");
+		else if (error == OTA_CONNECT_ERROR) Serial.println("Connect Failed");
+		else if (error == OTA_RECEIVE_ERROR) Serial.println("Receive Failed");
+		else if (error == OTA_END_ERROR) Serial.println("End Failed");
+	});
+	ArduinoOTA.begin();
+  renderPendingFrame();
+  
+  // NTP
+	Serial.println("Starting NTP module");
+	NTP.begin(Config.ntpserver, NtpCallback, 1, true);
+  renderPendingFrame();
+
+	// web server
+	Serial.println("Starting HTTP server");
+	iWebServer.begin();
+  renderPendingFrame();
+
+  // MQTT
+  MQTT.begin();
+
+  startup = false;
+  networkStarted = true;
+}
+
 //---------------------------------------------------------------------------------------
 // setup
 //
@@ -221,94 +280,18 @@ void setup()
 #else
   LED.begin(3);
 #endif
+  // after a warm reset continue with the time from RTC memory until NTP is available
+  NTPTimeAcquired = NTP.restoreTime(1, true);
   if (not RecoverFromException) 
   { 
-    LED.setMode(DisplayMode::yellowHourglass);
+    LED.setMode(NTPTimeAcquired ? Config.defaultMode : DisplayMode::yellowHourglass);
     LED.process();
   }
   
-  // timer
-	Serial.println("Starting timer");
-	timer.attach(TIMER_RESOLUTION / 1000.0, timerCallback);
-  
-	// WiFi
+	// WiFi, connects in the background and starts the network services when done
 	Serial.println("Initializing WiFi");
-  WiFi.setAutoReconnect(true);
-  // WiFi.mode(WIFI_STA); //WiFi mode station (connect to wifi router only)
-  // WiFi.setSleepMode(WIFI_NONE_SLEEP);
-  // WiFi.persistent(true);
-	WiFiManager wifiManager;
-	wifiManager.setAPCallback(configModeCallback);
-  wifiManager.setConnectTimeout(180);
-  wifiManager.setHostname("Wordclock");
-
-  if (!wifiManager.autoConnect(Config.hostname))
-	{
-		Serial.println("failed to connect, timeout");
-		delay(1000);
-#ifdef ESP32
-    ESP.restart();
-#else
-		ESP.reset();
-#endif
-  }
-	Serial.println("WiFi connected");
-	Serial.println("IP address: ");
-	Serial.println(WiFi.localIP()); 
-
-	setLED(0, 1, 0);
-
-	// OTA update
-	Serial.println("Initializing OTA");
-	ArduinoOTA.setPort(8266);
-	ArduinoOTA.setHostname(Config.hostname);
-	// ArduinoOTA.setPassword("WordClock");
-	ArduinoOTA.onStart([]()
-	{
-    MQTT.PublishStatus("offline");
-		LED.setMode(DisplayMode::update);
-		Config.updateProgress = 0;
-    Config.nightmode=false;
-		OTA_in_progress = 1;
-    LED.process();
-		Serial.println("OTA Start");
-	});
-	ArduinoOTA.onEnd([]()
-	{
-		LED.setMode(DisplayMode::updateComplete);
-    LED.process();
-		Serial.println("\nOTA End");
-	});
-	ArduinoOTA.onProgress([](unsigned int progress, unsigned int total)
-	{
-		LED.setMode(DisplayMode::update);
-		Config.updateProgress = (progress) * 110 / total;
-    LED.process();
-    Serial.printf("OTA Progress: %u%%\r\n", (progress / (total / 100)));
-	});
-	ArduinoOTA.onError([](ota_error_t error)
-	{
-		LED.setMode(DisplayMode::updateError);
-    LED.process();
-		Serial.printf("OTA Error[%u]: ", error);
-		if (error == OTA_AUTH_ERROR) Serial.println("Auth Failed");
-		else if (error == OTA_BEGIN_ERROR) Serial.println("Begin Failed");
-		else if (error == OTA_CONNECT_ERROR) Serial.println("Connect Failed");
-		else if (error == OTA_RECEIVE_ERROR) Serial.println("Receive Failed");
-		else if (error == OTA_END_ERROR) Serial.println("End Failed");
-	});
-	ArduinoOTA.begin();
-  
-  // NTP
-	Serial.println("Starting NTP module");
-	NTP.begin(Config.ntpserver, NtpCallback, 1, true);
-
-	// web server
-	Serial.println("Starting HTTP server");
-	iWebServer.begin();
-
-  // MQTT
-  MQTT.begin();
+  Network.begin(Config.hostname, startNetworkServices);
+  renderPendingFrame();
 
   //	telnetServer.begin();
   //	telnetServer.setNoDelay(true);
@@ -333,20 +316,26 @@ void loop()
   wdt_reset();
 #endif
   
-  // handle NTP
+  // WiFi connection, config portal and reconnect
+  Network.process();
+
+  // handle NTP, also keeps the time running without network
   NTP.process();
   
-  // do OTA update stuff
-  ArduinoOTA.handle();
+  if (networkStarted)
+  {
+    // do OTA update stuff
+    ArduinoOTA.handle();
 
-  // do web server stuff
-  iWebServer.process();
+    // do web server stuff
+    iWebServer.process();
+  }
 
   // do Config sutff
   Config.process();
 
   // do MQTT stuff
-  MQTT.process();
+  if (networkStarted) MQTT.process();
   
   // Feed watchdog again after network operations
 #ifndef ESP32
@@ -451,10 +440,11 @@ void loop()
             RecoverFromException=false;
             LED.setMode(DisplayMode::plain);
           } else {
-            LED.setMode(Config.defaultMode);
+            // notifications interrupt the display mode until all passes are done
+            LED.setMode(LED.isShowingText() && !Config.nightmode ? DisplayMode::scrollText : Config.defaultMode);
           }
         } else {
-          LED.setMode(DisplayMode::greenHourglass);
+          LED.setMode(Network.portalActive() ? DisplayMode::wifiManager : DisplayMode::greenHourglass);
         }
       }
   	}
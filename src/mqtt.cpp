@@ -10,6 +10,8 @@
 #include <PubSubClient.h>         // MQTT library
 #include "mqtt.h"
 #include "brightness.h"
+#include "ledfunctions.h"
+#include "parse.h"
 #include <ArduinoJson.h>
 
 //---------------------------------------------------------------------------------------
@@ -109,6 +111,18 @@ void MqttClass::process()
       this->mqtt_animspeed=Config.animspeed;
       this->UpdateMQTTNumber(ANIMATIONSPEEDNAME, this->mqtt_animspeed);
     }
+    if (this->mqtt_firecooling!=Config.fireCooling) {
+      this->mqtt_firecooling=Config.fireCooling;
+      this->UpdateMQTTNumber(FIRECOOLINGNAME, this->mqtt_firecooling);
+    }
+    if (this->mqtt_firesparking!=Config.fireSparking) {
+      this->mqtt_firesparking=Config.fireSparking;
+      this->UpdateMQTTNumber(FIRESPARKINGNAME, this->mqtt_firesparking);
+    }
+    if (this->mqtt_firewind!=Config.fireWind) {
+      this->mqtt_firewind=Config.fireWind;
+      this->UpdateMQTTNumber(FIREWINDNAME, this->mqtt_firewind);
+    }
     if (!isSameColor(Config.fg,this->fg)) {
       this->fg=Config.fg;
       this->UpdateMQTTColorDimmer(FOREGROUNDNAME, this->fg);
@@ -270,36 +284,7 @@ void MqttClass::PublishMQTTModeSelect(const char* uniquename)
   // json["val_tpl"] = "{{ value_json.mode }}";
 
   JsonArray options = json["options"].to<JsonArray>();
-  options.add("plain");
-  options.add("fade");  
-  options.add("flyingLettersVerticalUp");
-  options.add("flyingLettersVerticalDown");
-  options.add("explode");
-  options.add("plasma");
-  options.add("wakeup");
-  options.add("matrix");
-  options.add("heart");
-  options.add("fire");
-  options.add("stars");
-  options.add("random");
-  options.add("HorizontalStripes");
-  options.add("VerticalStripes");
-  options.add("RandomDots");
-  options.add("RandomStripes");
-  options.add("RotatingLine");
-  options.add("ChristmasTree");
-  options.add("JingleBells");
-  options.add("MerryChristmas");
-  options.add("HappyNewYear");
-  options.add("red");
-  options.add("green");
-  options.add("blue");
-  options.add("yellowHourglass");
-  options.add("greenHourglass");
-  options.add("update");
-  options.add("updateComplete");
-  options.add("updateError");
-  options.add("wifiManager");
+  for (int i = 0; i < NUM_EFFECTS; i++) options.add(LEDFunctionsClass::effects[i].name);
 
   addDeviceToJson(&json); // Add Device details to discovery message
 
@@ -481,104 +466,8 @@ void MqttClass::UpdateMQTTModeSelector(const char* uniquename, DisplayMode mode)
 {
   Serial.println(F("UpdateMQTTModeSelector"));
 
-  String displaymode;
-  
-  switch(mode)
-  {
-  case DisplayMode::plain:
-    displaymode="plain";
-    break;
-  case DisplayMode::fade:
-    displaymode="fade"; 
-    break;
-  case DisplayMode::flyingLettersVerticalUp:
-    displaymode="flyingLettersVerticalUp"; 
-    break;
-  case DisplayMode::flyingLettersVerticalDown:
-    displaymode="flyingLettersVerticalDown"; 
-    break;
-  case DisplayMode::explode:
-    displaymode="explode"; 
-    break;
-  case DisplayMode::wakeup:
-    displaymode="wakeup"; 
-    break;
-  case DisplayMode::matrix:
-    displaymode="matrix"; 
-    break;
-  case DisplayMode::heart:
-    displaymode="heart"; 
-    break;
-  case DisplayMode::fire:
-    displaymode="fire"; 
-    break;
-  case DisplayMode::stars:
-    displaymode="stars"; 
-    break;
-  case DisplayMode::random:
-    displaymode="random"; 
-    break;
-  case DisplayMode::HorizontalStripes:
-    displaymode="HorizontalStripes"; 
-    break;
-  case DisplayMode::VerticalStripes:
-    displaymode="VerticalStripes"; 
-    break;
-  case DisplayMode::RandomDots:
-    displaymode="RandomDots"; 
-    break;
-  case DisplayMode::RandomStripes:
-    displaymode="RandomStripes"; 
-    break;
-  case DisplayMode::RotatingLine:
-    displaymode="RotatingLine"; 
-    break;
-  case DisplayMode::plasma:
-    displaymode="plasma"; 
-    break;
-  case DisplayMode::red:
-    displaymode="red"; 
-    break;
-  case DisplayMode::green:
-    displaymode="green"; 
-    break;
-  case DisplayMode::blue:
-    displaymode="blue"; 
-    break;
-  case DisplayMode::yellowHourglass:
-    displaymode="yellowHourglass"; 
-    break;
-  case DisplayMode::greenHourglass:
-    displaymode="greenHourglass"; 
-    break;
-  case DisplayMode::update:
-    displaymode="update"; 
-    break;
-  case DisplayMode::updateComplete:
-    displaymode="updateComplete"; 
-    break;
-  case DisplayMode::updateError:
-    displaymode="updateError"; 
-    break;
-  case DisplayMode::wifiManager:
-    displaymode="wifiManager"; 
-    break;
-  case DisplayMode::christmastree:
-    displaymode="christmastree"; 
-    break;
-  case DisplayMode::jinglebells:
-    displaymode="jinglebells"; 
-    break;
-  case DisplayMode::merryChristmas:
-    displaymode="merryChristmas"; 
-    break;
-  case DisplayMode::happyNewYear:
-    displaymode="happyNewYear"; 
-    break;
-  default:
-    displaymode="unknown"; 
-    break;
-  }
+  const effect_descriptor *effect = LEDFunctionsClass::effect(mode);
+  String displaymode = effect != NULL ? effect->name : "unknown";
 
   // publish state message
   MQ.publish((String(Config.hostname)+FPSTR(MQTT_SELECT)+String(uniquename)+FPSTR(MQTT_STATE)).c_str(),displaymode.c_str(),Config.mqttpersistence);
@@ -621,7 +510,7 @@ void MqttClass::UpdateMQTTDimmer(const char* uniquename, bool Value, uint8_t  Mo
 // -> --
 // <- --
 //---------------------------------------------------------------------------------------
-void MqttClass::UpdateMQTTNumber(const char* uniquename, uint8_t Mod)
+void MqttClass::UpdateMQTTNumber(const char* uniquename, int Mod)
 {
   Serial.println(F("UpdateMQTTNumber"));
 
@@ -724,13 +613,20 @@ void MqttClass::PublishAllMQTTSensors()
     this->PublishMQTTDimmer(BACKGROUNDNAME,true);
     this->PublishMQTTDimmer(SECONDSNAME,true);
     this->PublishMQTTNumber(ANIMATIONSPEEDNAME,1,100,1,true);
+    this->PublishMQTTNumber(FIRECOOLINGNAME,0,FIRECOOLING_MAX,1,true);
+    this->PublishMQTTNumber(FIRESPARKINGNAME,0,FIRESPARKING_MAX,1,true);
+    this->PublishMQTTNumber(FIREWINDNAME,-FIREWIND_MAX,FIREWIND_MAX,1,true);
     this->PublishMQTTModeSelect(MODENAME);
     this->PublishMQTTText(DEBUGNAME);
     this->PublishMQTTSwitch(DEBUGNAME);
+    this->PublishMQTTText(NOTIFICATIONNAME);
 
     // Trick the program to communicate in the next run by making sure the mqtt cached values are set to the "wrong" values
     this->mqtt_brightness = Brightness.brightnessOverride==50 ? 51 : 50;
     this->mqtt_animspeed = Config.animspeed==50 ? 51 : 50;  
+    this->mqtt_firecooling = Config.fireCooling==50 ? 51 : 50;
+    this->mqtt_firesparking = Config.fireSparking==50 ? 51 : 50;
+    this->mqtt_firewind = Config.fireWind==50 ? 51 : 50;
     this->mqtt_nightmode = Config.nightmode ? false : true ;
     if (isSameColor(Config.fg,{0,0,0})) {
       this->fg={1,1,1};
@@ -819,7 +715,8 @@ palette_entry ProcessColorCommand(palette_entry OldColor, char* payloadstr)
     MQ.publish("log/payload",payloadstr);
     MQ.publish("log/error","Deserialisation failed");
   } else {
-    if (doc["state"].is<const char*>() && String(doc["state"]).equals("OFF")) {
+    bool state;
+    if (parseBool(doc["state"].as<const char*>(), state) && !state) {
       NewColor = {0,0,0}; // switch off if we have an off command     
     } else {
       // see if we have to process the color, at least remember old brightness and maxcolor
@@ -862,70 +759,12 @@ palette_entry ProcessColorCommand(palette_entry OldColor, char* payloadstr)
 //---------------------------------------------------------------------------------------
 DisplayMode GetDisplayModeFromPayload(String payload)
 {
-  if (payload=="plain") {
-    return DisplayMode::plain; 
-  } else if (payload=="fade") {
-    return DisplayMode::fade;
-  } else if (payload=="flyingLettersVerticalUp") {
-    return DisplayMode::flyingLettersVerticalUp;
-  } else if (payload=="flyingLettersVerticalDown") {
-    return DisplayMode::flyingLettersVerticalDown; 
-  } else if (payload=="explode") {
-    return DisplayMode::explode;
-  } else if (payload=="plasma") {
-    return DisplayMode::plasma;
-  } else if (payload=="wakeup") {
-    return DisplayMode::wakeup;
-  } else if (payload=="matrix") {
-    return DisplayMode::matrix;
-  } else if (payload=="heart") {
-    return DisplayMode::heart;
-  } else if (payload=="fire") {
-    return DisplayMode::fire;
-  } else if (payload=="stars") {
-    return DisplayMode::stars;
-  } else if (payload=="random") {
-    return DisplayMode::random;
-  } else if (payload=="HorizontalStripes") {
-    return DisplayMode::HorizontalStripes;
-  } else if (payload=="VerticalStripes") {
-    return DisplayMode::VerticalStripes;
-  } else if (payload=="RandomDots") {
-    return DisplayMode::RandomDots;
-  } else if (payload=="RandomStripes") {
-    return DisplayMode::RandomStripes;
-  } else if (payload=="RotatingLine") {
-    return DisplayMode::RotatingLine;
-  } else if (payload=="ChristmasTree") {
-    return DisplayMode::christmastree;
-  } else if (payload=="JingleBells") {
-    return DisplayMode::jinglebells;
-  } else if (payload=="MerryChristmas") {
-    return DisplayMode::merryChristmas;
-  } else if (payload=="HappyNewYear") {
-    return DisplayMode::happyNewYear;
-  } else if (payload=="red") {
-    return DisplayMode::red;
-  } else if (payload=="green") {
-    return DisplayMode::green;
-  } else if (payload=="blue") {
-    return DisplayMode::blue;
-  } else if (payload=="yellowHourglass") {
-    return DisplayMode::yellowHourglass;
-  } else if (payload=="greenHourglass") {
-    return DisplayMode::greenHourglass;
-  } else if (payload=="update") {
-    return DisplayMode::update;
-  } else if (payload=="updateComplete") {
-    return DisplayMode::updateComplete;
-  } else if (payload=="updateError") {
-    return DisplayMode::updateError;
-  } else if (payload=="wifiManager") {
-    return DisplayMode::wifiManager;
-  } else  {
+  const effect_descriptor *effect = LEDFunctionsClass::effectByName(payload.c_str());
+  if (effect == NULL) {
     Serial.println(F("Unknown display mode received by mqtt"));
     return DisplayMode::plain;
-  } 
+  }
+  return effect->mode;
 }
 
 //---------------------------------------------------------------------------------------
@@ -969,10 +808,21 @@ void MqttClass::MQTTcallback(char* topic, byte* payload, unsigned int length)
         Brightness.brightnessOverride = doc["brightness"];
         if (Brightness.brightnessOverride>0) Config.nightmode = false; // undo nightmode when a brightness level >0 is set
       }
-      if (doc["state"].is<const char*>()) Config.nightmode = String(doc["state"]).equals("ON") ? false: true;
+      bool state;
+      if (parseBool(doc["state"].as<const char*>(), state)) Config.nightmode = !state;
     } 
   } else if (topicstr.equals(NumberCommandTopic(ANIMATIONSPEEDNAME))) {
-    Config.animspeed = String(payloadstr).toInt();
+    long animspeed;
+    if (parseInt(payloadstr, animspeed, 1, 100)) Config.animspeed = animspeed;
+  } else if (topicstr.equals(NumberCommandTopic(FIRECOOLINGNAME))) {
+    long cooling;
+    if (parseInt(payloadstr, cooling, 0, FIRECOOLING_MAX)) Config.fireCooling = cooling;
+  } else if (topicstr.equals(NumberCommandTopic(FIRESPARKINGNAME))) {
+    long sparking;
+    if (parseInt(payloadstr, sparking, 0, FIRESPARKING_MAX)) Config.fireSparking = sparking;
+  } else if (topicstr.equals(NumberCommandTopic(FIREWINDNAME))) {
+    long wind;
+    if (parseInt(payloadstr, wind, -FIREWIND_MAX, FIREWIND_MAX)) Config.fireWind = wind;
   } else if (topicstr.equals(DimmerCommandTopic(FOREGROUNDNAME) ) ) {
     Config.fg=ProcessColorCommand(Config.fg, payloadstr); 
   } else if (topicstr.equals(DimmerCommandTopic(BACKGROUNDNAME) ) ) {
@@ -981,12 +831,13 @@ void MqttClass::MQTTcallback(char* topic, byte* payload, unsigned int length)
     Config.s=ProcessColorCommand(Config.s, payloadstr); 
   } else if (topicstr.equals(SelectorCommandTopic(MODENAME) ) ) {
     Config.defaultMode = GetDisplayModeFromPayload(payloadstr);
+  } else if (topicstr.equals(TextCommandTopic(NOTIFICATIONNAME) ) ) {
+    LED.showText(payloadstr, Config.fg, 1);
+    MQTT.UpdateMQTTText(NOTIFICATIONNAME, payloadstr);
   } else if (topicstr.equals(SwitchCommandTopic(DEBUGNAME) ) ) {
-    if (String(payloadstr).equals("ON")) {
-      MQTT.debugging=true;
-     } else {
-      MQTT.debugging=false;
-    } 
+    bool debugging = false;
+    parseBool(payloadstr, debugging);
+    MQTT.debugging = debugging;
   } else {
       MQ.publish("log/topic",topicstr.c_str());
       MQ.publish("log/payload",payloadstr);
@@ -0,0 +1,216 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  This module manages the WiFi connection without blocking the main loop. The
+//  station connects using the credentials stored by the SDK. If there are none, or
+//  the network can not be reached within NETWORK_CONNECT_TIMEOUT, the WiFiManager
+//  config portal is opened in non-blocking mode. When the portal times out the
+//  stored network is tried again instead of resetting the clock. A lost connection
+//  is retried periodically while the rest of the firmware keeps running.
+//
+//  The callback passed to begin() is executed once, on the first successful
+//  connection, to start the network services.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include <Arduino.h>
+#include "network.h"
+#include "config.h"
+
+//---------------------------------------------------------------------------------------
+// global instance
+//---------------------------------------------------------------------------------------
+NetworkClass Network = NetworkClass();
+
+//---------------------------------------------------------------------------------------
+// NetworkClass
+//
+// Constructor
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+NetworkClass::NetworkClass()
+{
+  // empty
+}
+
+//---------------------------------------------------------------------------------------
+// begin
+//
+// Starts connecting to the stored WiFi network
+//
+// -> hostname: host name, also used as SSID of the config portal
+//    callback: called once when the first connection is established
+// <- --
+//---------------------------------------------------------------------------------------
+void NetworkClass::begin(const char *hostname, TNetworkCallback callback)
+{
+	this->hostname = hostname;
+	this->_callback = callback;
+
+	if (Config.logLevel >= LOG_INFO) Serial.println(F("NetworkClass::begin()"));
+	WiFi.setAutoReconnect(true);
+	WiFi.mode(WIFI_STA);
+	WiFi.begin(); // stored credentials
+
+	this->wifiManager.setAPCallback(NetworkClass::configModeCallback);
+	this->wifiManager.setConfigPortalBlocking(false);
+	this->wifiManager.setConfigPortalTimeout(NETWORK_PORTAL_TIMEOUT);
+	this->wifiManager.setHostname("Wordclock");
+
+	this->setState(NetworkState::connecting);
+}
+
+//---------------------------------------------------------------------------------------
+// connected
+//
+// -> --
+// <- true if the station is connected
+//---------------------------------------------------------------------------------------
+bool NetworkClass::connected()
+{
+	return this->state == NetworkState::connected;
+}
+
+//---------------------------------------------------------------------------------------
+// portalActive
+//
+// -> --
+// <- true if the WiFiManager config portal is open
+//---------------------------------------------------------------------------------------
+bool NetworkClass::portalActive()
+{
+	return this->state == NetworkState::portal;
+}
+
+//---------------------------------------------------------------------------------------
+// configModeCallback
+//
+// Called by WiFiManager when the config portal access point has been started
+//
+// -> myWiFiManager: WiFiManager instance
+// <- --
+//---------------------------------------------------------------------------------------
+void NetworkClass::configModeCallback(WiFiManager *myWiFiManager)
+{
+	Serial.println(F("Entered config mode"));
+	Serial.println(WiFi.softAPIP());
+	Serial.println(myWiFiManager->getConfigPortalSSID());
+}
+
+//---------------------------------------------------------------------------------------
+// setState
+//
+// Switches to a new state and restarts the state timer
+//
+// -> newState: ...
+// <- --
+//---------------------------------------------------------------------------------------
+void NetworkClass::setState(NetworkState newState)
+{
+	this->state = newState;
+	this->stateMillis = millis();
+}
+
+//---------------------------------------------------------------------------------------
+// startPortal
+//
+// Opens the WiFiManager config portal in non-blocking mode
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void NetworkClass::startPortal()
+{
+	if (Config.logLevel >= LOG_INFO) Serial.println(F("NetworkClass: starting config portal"));
+	this->wifiManager.startConfigPortal(this->hostname);
+	this->setState(NetworkState::portal);
+}
+
+//---------------------------------------------------------------------------------------
+// process
+//
+// Function to be called by the main loop, drives the internal state machine
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void NetworkClass::process()
+{
+	unsigned long elapsed = millis() - this->stateMillis;
+
+	switch (this->state)
+	{
+	case NetworkState::connecting:
+		if (WiFi.status() == WL_CONNECTED)
+		{
+			this->setState(NetworkState::connected);
+		}
+		else if (WiFi.SSID().length() == 0 || elapsed > NETWORK_CONNECT_TIMEOUT)
+		{
+			this->startPortal();
+		}
+		break;
+
+	case NetworkState::portal:
+		this->wifiManager.process();
+		if (WiFi.status() == WL_CONNECTED)
+		{
+			this->wifiManager.stopConfigPortal();
+			this->setState(NetworkState::connected);
+		}
+		else if (!this->wifiManager.getConfigPortalActive())
+		{
+			if (Config.logLevel >= LOG_INFO) Serial.println(F("NetworkClass: config portal timeout, retrying stored network"));
+			WiFi.mode(WIFI_STA);
+			WiFi.begin();
+			this->setState(NetworkState::connecting);
+		}
+		break;
+
+	case NetworkState::connected:
+		if (WiFi.status() != WL_CONNECTED)
+		{
+			if (Config.logLevel >= LOG_INFO) Serial.println(F("NetworkClass: connection lost"));
+			this->setState(NetworkState::reconnecting);
+		}
+		break;
+
+	case NetworkState::reconnecting:
+		if (WiFi.status() == WL_CONNECTED)
+		{
+			this->setState(NetworkState::connected);
+		}
+		else if (elapsed > NETWORK_RECONNECT_INTERVAL)
+		{
+			if (Config.logLevel >= LOG_INFO) Serial.println(F("NetworkClass: reconnecting"));
+			WiFi.reconnect();
+			this->setState(NetworkState::reconnecting);
+		}
+		break;
+
+	case NetworkState::idle:
+	default:
+		break;
+	}
+
+	// start the network services on the first connection
+	if (this->state == NetworkState::connected && !this->servicesStarted)
+	{
+		Serial.print(F("WiFi connected, IP address: "));
+		Serial.println(WiFi.localIP());
+		this->servicesStarted = true;
+		if (this->_callback) this->_callback();
+	}
+}
@@ -8,6 +8,10 @@
 //  NTP request is retried automatically if no reply is being received. The request
 //  is being repeated every 59 minutes, so the calling module is updated regularly.
 //
+//  The current time is copied to RTC user memory once per second. After a warm reset
+//  (watchdog, exception, OTA, reset button) restoreTime() continues from there, so the
+//  clock can show the time before WiFi and NTP are available.
+//
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
 // the Free Software Foundation, either version 3 of the License, or
@@ -27,6 +31,7 @@
 #include <limits.h>
 #include "ntp.h"
 #include "ledfunctions.h"
+#include "crc32.h"
 
 
 //---------------------------------------------------------------------------------------
@@ -37,6 +42,8 @@
 #define NTP_TIMEOUT 5000
 #define TIMER_RESOLUTION 100
 #define NTP_RELOAD_INTERVAL (59*60*1000)
+#define NTP_RTC_OFFSET 64         // RTC user memory block, the lower blocks are used by eboot
+#define NTP_RTC_MAGIC 0x4E545043  // "NTPC"
 
 //---------------------------------------------------------------------------------------
 // global instance
@@ -111,7 +118,6 @@ void NtpClass::begin(IPAddress ip, TNtpCallback callback, int timezone, bool DST
 	Serial.println(F("NtpClass::begin()")); // Waiting 2 seconds");
 	this->state = NtpState::waitingForReload;
 	this->timer = NTP_RELOAD_INTERVAL; // - 2000;
-  this->previousMillis = 0;
 }
 
 //---------------------------------------------------------------------------------------
@@ -149,6 +155,9 @@ void NtpClass::process()
   }
 
   
+  // keep a copy of the time for the next warm reset
+  if (this->s != this->lastSavedSecond) this->saveTime();
+
   // increment timer variable
   this->timer += (unsigned long)(millis()-previousMillis);
   previousMillis=millis();
@@ -280,7 +289,6 @@ bool NtpClass::isDSTactive()
 void NtpClass::parse()
 {
 	byte buf[NTP_PACKET_SIZE];
-	bool DST = false;
 
 	Serial.print(F("NtpClass::parse() ("));
 	Serial.print(this->timer);
@@ -291,6 +299,27 @@ void NtpClass::parse()
 	unsigned long lowWord = word(buf[42], buf[43]);
 	unsigned long secsSince1970 = (highWord << 16 | lowWord) - 2208988800ULL;
 
+	this->ms = 0;
+	this->setTime(secsSince1970);
+	Serial.print(F("ms), "));
+}
+
+//---------------------------------------------------------------------------------------
+// setTime
+//
+// Sets the local date and time from a UTC timestamp, applying time zone and DST
+//
+// -> secsSince1970: Unix timestamp (UTC)
+// <- --
+//---------------------------------------------------------------------------------------
+void NtpClass::setTime(unsigned long secsSince1970)
+{
+	bool DST = false;
+
+	this->epoch = secsSince1970;
+	this->epochMillis = millis() - this->ms;
+	this->epochValid = true;
+
 	// calculate date and time from timestamp
 	this->decodeTime(secsSince1970 + this->tz);
 	randomSeed(secsSince1970);
@@ -306,10 +335,71 @@ void NtpClass::parse()
 			this->decodeTime(secsSince1970 + this->tz + 3600);
 		}
 	}
-	Serial.printf("ms), local time: %02i:%02i:%02i, date: %i-%02i-%02i, "
+	Serial.printf("local time: %02i:%02i:%02i, date: %i-%02i-%02i, "
 			"weekday=%i, DST=%i\r\n", h, m, s, year, month, day, weekday, DST);
 }
 
+//---------------------------------------------------------------------------------------
+// saveTime
+//
+// Stores the current UTC time in RTC user memory
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void NtpClass::saveTime()
+{
+	this->lastSavedSecond = this->s;
+#ifndef ESP32
+	if (!this->epochValid) return;
+
+	unsigned long elapsed = millis() - this->epochMillis;
+	rtc_time t;
+	t.magic = NTP_RTC_MAGIC;
+	t.epoch = this->epoch + elapsed / 1000;
+	t.ms = elapsed % 1000;
+	t.crc = crc32Update(CRC32_INIT, &t, offsetof(rtc_time, crc)) ^ CRC32_INIT;
+	ESP.rtcUserMemoryWrite(NTP_RTC_OFFSET, (uint32_t*)&t, sizeof(t));
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+// restoreTime
+//
+// Restores the time saved in RTC user memory before the last reset. The time spent
+// since the reset (millis()) is added, the duration of the reset itself is lost.
+// Must be called before begin().
+//
+// -> timezone, DST: see begin()
+// <- true if a valid time was found
+//---------------------------------------------------------------------------------------
+bool NtpClass::restoreTime(int timezone, bool DST)
+{
+#ifdef ESP32
+	return false;
+#else
+	rtc_time t;
+	if (!ESP.rtcUserMemoryRead(NTP_RTC_OFFSET, (uint32_t*)&t, sizeof(t))) return false;
+	if (t.magic != NTP_RTC_MAGIC ||
+		t.crc != (crc32Update(CRC32_INIT, &t, offsetof(rtc_time, crc)) ^ CRC32_INIT))
+	{
+		Serial.println(F("NtpClass: no time in RTC memory"));
+		return false;
+	}
+
+	this->tz = timezone * 3600;
+	this->useDST = DST;
+
+	unsigned long total = t.ms + millis();
+	this->ms = total % 1000;
+	Serial.print(F("NtpClass: time restored from RTC memory, "));
+	this->setTime(t.epoch + total / 1000);
+	this->previousMillis = millis();
+	this->lastSavedSecond = this->s;
+	return true;
+#endif
+}
+
 //---------------------------------------------------------------------------------------
 // sendNTPpacket
 //
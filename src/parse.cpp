@@ -0,0 +1,246 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Allocation free parsers for the values received by the web server and via MQTT.
+//  All functions work directly on the zero terminated argument string, accept only
+//  the complete string (no trailing garbage) and leave the result untouched if the
+//  input is invalid. They do not depend on the Arduino core.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "parse.h"
+
+//---------------------------------------------------------------------------------------
+// hexDigit
+//
+// Converts a single hexadecimal digit
+//
+// -> c: character to convert
+// <- value 0..15, -1 if c is not a hexadecimal digit
+//---------------------------------------------------------------------------------------
+static int hexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+//---------------------------------------------------------------------------------------
+// equalsIgnoreCase
+//
+// Compares a string with a lower case ASCII keyword
+//
+// -> s: string to compare
+//    keyword: lower case keyword
+// <- true if both are equal ignoring the case of s
+//---------------------------------------------------------------------------------------
+static bool equalsIgnoreCase(const char *s, const char *keyword)
+{
+	while (*keyword)
+	{
+		char c = *s++;
+		if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+		if (c != *keyword++) return false;
+	}
+	return *s == 0;
+}
+
+//---------------------------------------------------------------------------------------
+// parseHexColor
+//
+// Parses an HTML color "rrggbb", with or without leading '#'
+//
+// -> s: string to parse
+//    r, g, b: receive the color components
+// <- true if s was a valid color
+//---------------------------------------------------------------------------------------
+bool parseHexColor(const char *s, uint8_t &r, uint8_t &g, uint8_t &b)
+{
+	uint8_t v[3];
+
+	if (!s) return false;
+	if (*s == '#') s++;
+	for (int i = 0; i < 3; i++)
+	{
+		int hi = hexDigit(s[2*i]);
+		if (hi < 0) return false;
+		int lo = hexDigit(s[2*i+1]);
+		if (lo < 0) return false;
+		v[i] = (hi << 4) | lo;
+	}
+	if (s[6] != 0) return false;
+
+	r = v[0];
+	g = v[1];
+	b = v[2];
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// parseInt
+//
+// Parses a decimal integer with optional sign and checks its range
+//
+// -> s: string to parse
+//    result: receives the value
+//    min, max: allowed range (inclusive)
+// <- true if s was a valid number within the range
+//---------------------------------------------------------------------------------------
+bool parseInt(const char *s, long &result, long min, long max)
+{
+	bool negative = false;
+	long value = 0;
+
+	if (!s) return false;
+	if (*s == '-' || *s == '+') negative = (*s++ == '-');
+	if (*s == 0) return false;
+
+	for (; *s; s++)
+	{
+		if (*s < '0' || *s > '9') return false;
+		value = value * 10 + (*s - '0');
+
+		// stop early, this also prevents overflow of value
+		if (value > max && !negative) return false;
+		if (-value < min && negative) return false;
+	}
+
+	if (negative) value = -value;
+	if (value < min || value > max) return false;
+	result = value;
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// parseHex32
+//
+// Parses an unsigned hexadecimal number of up to 8 digits, with or without leading
+// "0x"
+//
+// -> s: string to parse
+//    result: receives the value
+// <- true if s was a valid number
+//---------------------------------------------------------------------------------------
+bool parseHex32(const char *s, uint32_t &result)
+{
+	uint32_t value = 0;
+	int digits = 0;
+
+	if (!s) return false;
+	if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) s += 2;
+	for (; *s; s++)
+	{
+		int d = hexDigit(*s);
+		if (d < 0 || ++digits > 8) return false;
+		value = (value << 4) | d;
+	}
+	if (digits == 0) return false;
+
+	result = value;
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// parseIP
+//
+// Parses an IPv4 address in dotted decimal notation
+//
+// -> s: string to parse
+//    ip: receives the four address bytes
+// <- true if s was a valid address
+//---------------------------------------------------------------------------------------
+bool parseIP(const char *s, uint8_t ip[4])
+{
+	uint8_t v[4];
+
+	if (!s) return false;
+	for (int i = 0; i < 4; i++)
+	{
+		int value = 0, digits = 0;
+		while (*s >= '0' && *s <= '9')
+		{
+			value = value * 10 + (*s++ - '0');
+			if (++digits > 3 || value > 255) return false;
+		}
+		if (digits == 0) return false;
+		if (*s != (i < 3 ? '.' : 0)) return false;
+		if (i < 3) s++;
+		v[i] = value;
+	}
+
+	for (int i = 0; i < 4; i++) ip[i] = v[i];
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// parseBool
+//
+// Parses a boolean value: 1/0, on/off, true/false or yes/no (case insensitive)
+//
+// -> s: string to parse
+//    result: receives the value
+// <- true if s was a valid boolean
+//---------------------------------------------------------------------------------------
+bool parseBool(const char *s, bool &result)
+{
+	if (!s) return false;
+	if (equalsIgnoreCase(s, "1") || equalsIgnoreCase(s, "on") ||
+		equalsIgnoreCase(s, "true") || equalsIgnoreCase(s, "yes"))
+	{
+		result = true;
+		return true;
+	}
+	if (equalsIgnoreCase(s, "0") || equalsIgnoreCase(s, "off") ||
+		equalsIgnoreCase(s, "false") || equalsIgnoreCase(s, "no"))
+	{
+		result = false;
+		return true;
+	}
+	return false;
+}
+
+//---------------------------------------------------------------------------------------
+// parseTime
+//
+// Parses a time of day "h:mm" or "hh:mm"
+//
+// -> s: string to parse
+//    h, m: receive hours (0..23) and minutes (0..59)
+// <- true if s was a valid time
+//---------------------------------------------------------------------------------------
+bool parseTime(const char *s, int &h, int &m)
+{
+	int hours = 0, minutes = 0, digits = 0;
+
+	if (!s) return false;
+	while (*s >= '0' && *s <= '9')
+	{
+		hours = hours * 10 + (*s++ - '0');
+		if (++digits > 2) return false;
+	}
+	if (digits == 0 || *s++ != ':') return false;
+
+	digits = 0;
+	while (*s >= '0' && *s <= '9')
+	{
+		minutes = minutes * 10 + (*s++ - '0');
+		if (++digits > 2) return false;
+	}
+	if (digits != 2 || *s != 0) return false;
+	if (hours > 23 || minutes > 59) return false;
+
+	h = hours;
+	m = minutes;
+	return true;
+}
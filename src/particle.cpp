@@ -18,12 +18,14 @@
 #include <math.h>
 #include "particle.h"
 #include "ledfunctions.h"
+#include "gamma.h"
 
 //---------------------------------------------------------------------------------------
 // brightness gradient for moving particle
 //---------------------------------------------------------------------------------------
-const float Particle::ParticleGradient[MAX_PARTICLE_DISTANCE] = {
-	1, 0.75, 0.5, 0.25, 0.125, 0.06, 0.03, 0.01 };
+// intensity of the particle depending on the traveled distance, 256 = 100%
+const uint16_t Particle::ParticleGradient[MAX_PARTICLE_DISTANCE] = {
+	256, 192, 128, 64, 32, 15, 8, 3 };
 
 //---------------------------------------------------------------------------------------
 // Particle
@@ -137,27 +139,13 @@ void Particle::render(uint8_t *target, palette_entry palette[])
 	// limit distance
 	if(d >= MAX_PARTICLE_DISTANCE) d = MAX_PARTICLE_DISTANCE - 1;
 
-	// get palette color for foreground
-	float pr = (float)palette[1].r;
-	float pg = (float)palette[1].g;
-	float pb = (float)palette[1].b;
-
 	// calculate offset in buffer from given coordinates
 	int ofs = LEDFunctionsClass::getOffset(this->x, this->y);
 
-	// calculate fading color depending on distance from starting point and add it
-	// to the previous value of the pixel corresponding to the particle
-	float r = (float)target[ofs + 0] + pr * ParticleGradient[d];
-	float g = (float)target[ofs + 1] + pg * ParticleGradient[d];
-	float b = (float)target[ofs + 2] + pb * ParticleGradient[d];
-
-	// limit brightness value of each component to foreground color values
-	if(r > pr) r = pr;
-	if(g > pg) g = pg;
-	if(b > pb) b = pb;
-
-	// write back pixel color
-	target[ofs + 0] = r;
-	target[ofs + 1] = g;
-	target[ofs + 2] = b;
+	// add the foreground color, faded depending on distance from starting point, to
+	// the previous value of the pixel in linear light, limited to the foreground color
+	uint16_t w = ParticleGradient[d];
+	target[ofs + 0] = gammaAdd(target[ofs + 0], palette[1].r, w, palette[1].r);
+	target[ofs + 1] = gammaAdd(target[ofs + 1], palette[1].g, w, palette[1].g);
+	target[ofs + 2] = gammaAdd(target[ofs + 2], palette[1].b, w, palette[1].b);
 }
@@ -0,0 +1,165 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Scrolls text and sprites horizontally through an indexed frame. A message is
+//  converted once into a stream of columns: text columns hold the row bits of a glyph
+//  from the font in font_5x10.h together with a palette index, sprite columns refer
+//  to a column of an indexed PROGMEM sprite. Each step() moves the frame one column
+//  to the left and draws only the column entering at the right edge.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <Arduino.h>
+#include "scrolltext.h"
+#include "font_5x10.h"
+
+//---------------------------------------------------------------------------------------
+// clear
+//
+// Removes the message and starts over at its first column
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void ScrollText::clear()
+{
+	this->columns.clear();
+	this->sprite = nullptr;
+	this->position = 0;
+}
+
+//---------------------------------------------------------------------------------------
+// addText
+//
+// Appends the glyphs of a text to the message, each followed by an empty column.
+// Characters missing in the font are shown as '?', multi byte UTF-8 sequences count
+// as one character.
+//
+// -> text: zero terminated text
+//    colors: palette index per character of text, NULL to use color for all
+//    color: palette index 1..15 if colors is NULL
+// <- --
+//---------------------------------------------------------------------------------------
+void ScrollText::addText(const char *text, const uint8_t *colors, uint8_t color)
+{
+	for (int i = 0; *text; text++)
+	{
+		uint8_t c = *text;
+
+		// skip the continuation bytes of UTF-8 sequences
+		if ((c & 0xC0) == 0x80) continue;
+		if (c < FONT_FIRST || c > FONT_LAST) c = '?';
+
+		uint16_t bits = (uint16_t)((colors ? colors[i] : color) & 0x0F) << 10;
+		int first = pgm_read_word(&font_offsets[c - FONT_FIRST]);
+		int last = pgm_read_word(&font_offsets[c - FONT_FIRST + 1]);
+		for (int x = first; x < last; x++)
+		{
+			this->columns.push_back(bits | pgm_read_word(&font_columns[x]));
+		}
+		this->columns.push_back(0);
+		i++;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// addSprite
+//
+// Appends an indexed sprite to the message. All sprites of a message must be the same
+// data, only the last one passed is shown.
+//
+// -> sprite: PROGMEM, SCROLLTEXT_HEIGHT palette indexes per column, column by column
+//    width: number of columns
+// <- --
+//---------------------------------------------------------------------------------------
+void ScrollText::addSprite(const uint8_t *sprite, int width)
+{
+	this->sprite = sprite;
+	for (int x = 0; x < width; x++) this->columns.push_back(SCROLLTEXT_SPRITE | x);
+}
+
+//---------------------------------------------------------------------------------------
+// addGap
+//
+// Appends empty columns to the message
+//
+// -> columns: number of columns
+// <- --
+//---------------------------------------------------------------------------------------
+void ScrollText::addGap(int columns)
+{
+	this->columns.insert(this->columns.end(), columns, 0);
+}
+
+//---------------------------------------------------------------------------------------
+// rewind
+//
+// Starts the message over, the next step() shows its first column at the right edge
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void ScrollText::rewind()
+{
+	this->position = 0;
+}
+
+//---------------------------------------------------------------------------------------
+// length
+//
+// Returns the number of columns of the message
+//
+// -> --
+// <- number of columns
+//---------------------------------------------------------------------------------------
+int ScrollText::length()
+{
+	return this->columns.size();
+}
+
+//---------------------------------------------------------------------------------------
+// step
+//
+// Scrolls the message one column to the left. The frame must hold the previous step,
+// only the rightmost column is drawn from the message. After the last column empty
+// columns enter until the message has left the frame.
+//
+// -> frame: indexed frame, x + y * width, the top SCROLLTEXT_HEIGHT rows are used
+//    width, height: size of the frame
+// <- false if the message has completely left the frame, true otherwise
+//---------------------------------------------------------------------------------------
+bool ScrollText::step(uint8_t *frame, int width, int height)
+{
+	if (this->position >= (int)this->columns.size() + width) return false;
+
+	uint16_t column = this->position < (int)this->columns.size() ? this->columns[this->position] : 0;
+	this->position++;
+
+	if (height > SCROLLTEXT_HEIGHT) height = SCROLLTEXT_HEIGHT;
+	for (int y = 0; y < height; y++)
+	{
+		uint8_t *row = frame + y * width;
+		memmove(row, row + 1, width - 1);
+
+		if (column & SCROLLTEXT_SPRITE)
+		{
+			row[width - 1] = pgm_read_byte(&this->sprite[(column & ~SCROLLTEXT_SPRITE) * SCROLLTEXT_HEIGHT + y]);
+		}
+		else
+		{
+			row[width - 1] = (column & (1 << y)) ? (column & SCROLLTEXT_COLOR) >> 10 : 0;
+		}
+	}
+	return true;
+}
@@ -1,7 +1,7 @@
 // ESP8266 Wordclock
 // Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
 //
-//  This class represents a start object for the stars screen saver.
+//  This class represents a star object for the stars screen saver.
 //
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -20,69 +20,72 @@
 #include "ledfunctions.h"
 
 //---------------------------------------------------------------------------------------
-// StarObject
+// mark
 //
-// Constructor
+// Adds delta to all cells of the occupancy grid closer to this star than the minimum
+// distance. A cell is free for a new star while its count is zero.
 //
-// -> --
+// -> blocked: occupancy grid, one counter per LED (x + y * width)
+//    delta: 1 when the star is placed, -1 when it is removed
 // <- --
 //---------------------------------------------------------------------------------------
-StarObject::StarObject()
+void StarObject::mark(uint8_t *blocked, int delta)
 {
+	for (int dy = -2; dy <= 2; dy++)
+	{
+		int y = this->y + dy;
+		if (y < 0 || y >= LEDFunctionsClass::height) continue;
+		for (int dx = -2; dx <= 2; dx++)
+		{
+			int x = this->x + dx;
+			if (x < 0 || x >= LEDFunctionsClass::width) continue;
+			if (dx * dx + dy * dy >= StarObject::minimumDistanceSquared) continue;
+			blocked[x + y * LEDFunctionsClass::width] += delta;
+		}
+	}
 }
 
 //---------------------------------------------------------------------------------------
 // randomize
 //
-// Assigns new random coordinates and speed, retries until new coordinates have a
-// distance of minimum 2 LEDs.
+// Assigns new random coordinates and speed. The coordinates are drawn from the cells
+// that keep a distance of minimum 2 LEDs to all other stars, if there is none, any
+// cell is used.
 //
-// -> allStars: Reference to outer container for distance calculation to other stars
+// -> blocked: occupancy grid shared by all stars, see mark()
 // <- --
 //---------------------------------------------------------------------------------------
-void StarObject::randomize(std::vector<StarObject> &allStars)
+void StarObject::randomize(uint8_t *blocked)
 {
-	// set coordinates of self to default value
-	this->x = -1;
-	this->y = -1;
-
-	int retryCount = 0;
-	bool distanceOK;
-	int newX = 0, newY = 0, dx, dy;
+	const int cells = LEDFunctionsClass::width * LEDFunctionsClass::height;
 
-	do
-	{
-		// assume distance is OK
-		distanceOK = true;
+	// release the old position
+	if (this->speed != 0) this->mark(blocked, -1);
 
-		// create new random pair
-		newX = random(LEDFunctionsClass::width);
-		newY = random(LEDFunctionsClass::height);
-		retryCount++;
+	int freeCells = 0;
+	for (int i = 0; i < cells; i++) if (blocked[i] == 0) freeCells++;
 
-		// iterate over all other stars and check distance to newly generated coordinate
-		for (StarObject s : allStars)
+	int cell;
+	if (freeCells > 0)
+	{
+		// pick the n-th free cell
+		int n = random(freeCells);
+		for (cell = 0; cell < cells; cell++)
 		{
-			// skip if default value
-			if (s.x == -1) continue;
-
-			// calculate distance
-			dx = newX - s.x;
-			dy = newY - s.y;
-			if (dx * dx + dy * dy < StarObject::minimumDistanceSquared)
-			{
-				// retry if distance to any star is below limit
-				distanceOK = false;
-				break;
-			}
+			if (blocked[cell] == 0 && n-- == 0) break;
 		}
-	} while (!distanceOK && retryCount < 100);
+	}
+	else
+	{
+		cell = random(cells);
+	}
 
-	this->x = newX;
-	this->y = newY;
+	this->x = cell % LEDFunctionsClass::width;
+	this->y = cell / LEDFunctionsClass::width;
 	this->speed = 15 + random(15);
 	this->state = 0;
 	this->brightness = 0;
+	this->mark(blocked, 1);
 }
 
 //---------------------------------------------------------------------------------------
@@ -91,11 +94,11 @@ void StarObject::randomize(std::vector<StarObject> &allStars)
 // Updates the state of the star object. Increases brightness up to maximum, then
 // decreases to zero, then randomizes to new coordinates and speed and starts again.
 //
-// -> allStars: Reference to vector containing all stars, necessary for distance
-//              calculation when creating new random position
+// -> blocked: occupancy grid, necessary for distance calculation when creating new
+//             random position
 // <- --
 //---------------------------------------------------------------------------------------
-void StarObject::update(std::vector<StarObject> &allStars)
+void StarObject::update(uint8_t *blocked)
 {
 	// increase or decrease brightness depending on current state
 	if (this->state == 0)
@@ -116,7 +119,7 @@ void StarObject::update(std::vector<StarObject> &allStars)
 			// switch to increasing mode and get new random coordinates
 			this->brightness = 0;
 			this->state = 0;
-			this->randomize(allStars);
+			this->randomize(blocked);
 		}
 	}
 }
@@ -127,13 +130,13 @@ void StarObject::update(std::vector<StarObject> &allStars)
 // Updates own status (see StarObject::update()) and renders self to buffer.
 //
 // -> buf: RGB buffer for LED colors
-//    allStars: Reference to vector containing all stars, necessary for distance
-//              calculation when creating new random position
+//    blocked: occupancy grid, necessary for distance calculation when creating new
+//             random position
 // <- --
 //---------------------------------------------------------------------------------------
-void StarObject::render(uint8_t* buf, std::vector<StarObject> &allStars)
+void StarObject::render(uint8_t* buf, uint8_t *blocked)
 {
-	this->update(allStars);
+	this->update(blocked);
 
 	// write brightness to target buffer
 	int offset = LEDFunctionsClass::getOffset(this->x, this->y);
@@ -0,0 +1,472 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  This module wraps ESPAsyncWebServer behind the subset of the ESP8266WebServer
+//  interface used by WebServerClass. Requests are received and parsed event driven
+//  by the TCP stack, complete requests are queued and their handlers are run from
+//  the main loop, at most WEBBACKEND_MAX_DISPATCH per call to handleClient(). Files
+//  are sent by the TCP stack in chunks as the client acknowledges data, so neither a
+//  slow client nor a large file stalls the LED rendering.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <ESPAsyncWebServer.h>
+#include "webbackend.h"
+
+// values of HTTPMethod and HTTPUploadStatus in ESP8266WebServer.h, which can not be
+// included here (see webbackend.h)
+#define METHOD_ANY     0
+#define METHOD_GET     1
+#define METHOD_HEAD    2
+#define METHOD_POST    3
+#define METHOD_PUT     4
+#define METHOD_PATCH   5
+#define METHOD_DELETE  6
+#define METHOD_OPTIONS 7
+
+#define UPLOAD_START   0
+#define UPLOAD_WRITE   1
+#define UPLOAD_END     2
+#define UPLOAD_ABORTED 3
+
+//---------------------------------------------------------------------------------------
+// toMethod
+//
+// Converts the method bit of an async request to the HTTPMethod numbering
+//
+// -> m: method as reported by AsyncWebServerRequest::method()
+// <- method number as used by ESP8266WebServer
+//---------------------------------------------------------------------------------------
+static int toMethod(WebRequestMethodComposite m)
+{
+	if (m & HTTP_GET) return METHOD_GET;
+	if (m & HTTP_POST) return METHOD_POST;
+	if (m & HTTP_HEAD) return METHOD_HEAD;
+	if (m & HTTP_PUT) return METHOD_PUT;
+	if (m & HTTP_PATCH) return METHOD_PATCH;
+	if (m & HTTP_DELETE) return METHOD_DELETE;
+	if (m & HTTP_OPTIONS) return METHOD_OPTIONS;
+	return METHOD_ANY;
+}
+
+//---------------------------------------------------------------------------------------
+// AsyncWebBackend
+//
+// Constructor, creates the underlying async server
+//
+// -> port: TCP port to listen on
+// <- --
+//---------------------------------------------------------------------------------------
+AsyncWebBackend::AsyncWebBackend(int port)
+{
+	this->server = new AsyncWebServer(port);
+}
+
+//---------------------------------------------------------------------------------------
+// ~AsyncWebBackend
+//
+// Destructor, removes the underlying async server
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+AsyncWebBackend::~AsyncWebBackend()
+{
+	if (this->server)
+		delete this->server;
+}
+
+//---------------------------------------------------------------------------------------
+// on
+//
+// Registers a handler for the given URI, see ESP8266WebServer::on()
+//
+// -> uri: exact path to match
+//    method: HTTP method to match, METHOD_ANY matches all
+//    handler: called from handleClient() when the request is complete
+//    uploadHandler: called for every chunk of a multipart file upload
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::on(const char *uri, THandlerFunction handler)
+{
+	this->on(uri, METHOD_ANY, handler, nullptr);
+}
+
+void AsyncWebBackend::on(const char *uri, int method, THandlerFunction handler)
+{
+	this->on(uri, method, handler, nullptr);
+}
+
+void AsyncWebBackend::on(const char *uri, int method, THandlerFunction handler,
+	THandlerFunction uploadHandler)
+{
+	Route r;
+	r.uri = uri;
+	r.method = method;
+	r.handler = handler;
+	r.uploadHandler = uploadHandler;
+	this->routes.push_back(r);
+}
+
+//---------------------------------------------------------------------------------------
+// onNotFound
+//
+// Registers the handler for requests not matching any route
+//
+// -> handler: called from handleClient()
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::onNotFound(THandlerFunction handler)
+{
+	this->notFoundHandler = handler;
+}
+
+//---------------------------------------------------------------------------------------
+// begin
+//
+// Hooks the catch-all callbacks of the async server and starts listening. Routing is
+// done by this class, so all requests end up in the catch-all handlers.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::begin()
+{
+	this->server->onNotFound([this](AsyncWebServerRequest *request) {
+		this->enqueue(request);
+	});
+	this->server->onFileUpload([this](AsyncWebServerRequest *request,
+		const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
+		this->handleUploadChunk(request, filename, index, data, len, final);
+	});
+	this->server->onRequestBody([this](AsyncWebServerRequest *request, uint8_t *data,
+		size_t len, size_t index, size_t total) {
+		this->handleBody(request, data, len, index, total);
+	});
+	this->server->begin();
+}
+
+//---------------------------------------------------------------------------------------
+// handleClient
+//
+// Must be called repeatedly from main loop. Runs the handlers of at most
+// WEBBACKEND_MAX_DISPATCH queued requests.
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::handleClient()
+{
+	for (int n = 0; n < WEBBACKEND_MAX_DISPATCH && this->queueCount > 0; n++)
+	{
+		AsyncWebServerRequest *request = this->queue[this->queueHead];
+		this->queueHead = (this->queueHead + 1) % WEBBACKEND_QUEUE_SIZE;
+		this->queueCount--;
+
+		this->current = request;
+		this->responded = false;
+		this->currentUri = request->url();
+		this->plainBody = request->_tempObject ? (const char *)request->_tempObject : "";
+		Serial.printf("%s called\n\r", this->currentUri.c_str());
+
+		int r = this->findRoute(request);
+		if (r >= 0)
+			this->routes[r].handler();
+		else if (this->notFoundHandler)
+			this->notFoundHandler();
+
+		// the client may have disconnected while the handler was running
+		if (this->current && !this->responded)
+			this->current->send(r >= 0 ? 400 : 404);
+
+		this->current = NULL;
+		this->plainBody = String();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// findRoute
+//
+// Looks up the route matching URI and method of a request
+//
+// -> request: request to match
+// <- index into this->routes, -1 if no route matches
+//---------------------------------------------------------------------------------------
+int AsyncWebBackend::findRoute(AsyncWebServerRequest *request)
+{
+	int m = toMethod(request->method());
+	for (unsigned int i = 0; i < this->routes.size(); i++)
+	{
+		const Route &r = this->routes[i];
+		if ((r.method == METHOD_ANY || r.method == m) && r.uri == request->url())
+			return i;
+	}
+	return -1;
+}
+
+//---------------------------------------------------------------------------------------
+// enqueue
+//
+// Called by the async server when a request has been received completely. The
+// request stays owned by the async server, it is removed from the queue again if the
+// client disconnects before it was handled.
+//
+// -> request: completed request
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::enqueue(AsyncWebServerRequest *request)
+{
+	// the upload handler already replied (e.g. file could not be created)
+	if (request == this->answered)
+	{
+		this->answered = NULL;
+		return;
+	}
+
+	if (this->queueCount >= WEBBACKEND_QUEUE_SIZE)
+	{
+		request->send(503);
+		return;
+	}
+
+	this->queue[(this->queueHead + this->queueCount) % WEBBACKEND_QUEUE_SIZE] = request;
+	this->queueCount++;
+	request->onDisconnect([this, request]() {
+		this->drop(request);
+	});
+}
+
+//---------------------------------------------------------------------------------------
+// drop
+//
+// Forgets all references to a request which is about to be deleted by the async
+// server, aborts a running upload
+//
+// -> request: request which is being disconnected
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::drop(AsyncWebServerRequest *request)
+{
+	uint8_t kept = 0;
+	for (uint8_t i = 0; i < this->queueCount; i++)
+	{
+		AsyncWebServerRequest *r =
+			this->queue[(this->queueHead + i) % WEBBACKEND_QUEUE_SIZE];
+		if (r != request)
+			this->queue[(this->queueHead + kept++) % WEBBACKEND_QUEUE_SIZE] = r;
+	}
+	this->queueCount = kept;
+
+	if (request == this->uploading)
+	{
+		this->current = request;
+		this->inUpload = true;
+		this->currentUpload.status = UPLOAD_ABORTED;
+		this->currentUpload.currentSize = 0;
+		this->currentUpload.buf = NULL;
+		if (this->uploadRoute >= 0)
+			this->routes[this->uploadRoute].uploadHandler();
+		this->inUpload = false;
+		this->uploading = NULL;
+	}
+
+	if (request == this->current) this->current = NULL;
+	if (request == this->answered) this->answered = NULL;
+}
+
+//---------------------------------------------------------------------------------------
+// handleUploadChunk
+//
+// Called by the async server for every received chunk of a multipart file upload.
+// Translates the chunk into the UPLOAD_FILE_START/WRITE/END sequence of
+// ESP8266WebServer and passes it on to the upload handler of the matching route.
+//
+// -> request: request the upload belongs to
+//    filename: name of the uploaded file
+//    index: offset of this chunk within the file
+//    data, len: chunk data
+//    final: true for the last chunk
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::handleUploadChunk(AsyncWebServerRequest *request,
+	const String& filename, size_t index, uint8_t *data, size_t len, bool final)
+{
+	int r = this->findRoute(request);
+	if (r < 0 || !this->routes[r].uploadHandler) return;
+
+	AsyncWebServerRequest *previous = this->current;
+	this->current = request;
+	this->inUpload = true;
+	WebUpload &u = this->currentUpload;
+
+	if (index == 0)
+	{
+		this->uploading = request;
+		this->uploadRoute = r;
+		this->responded = false;
+		request->onDisconnect([this, request]() {
+			this->drop(request);
+		});
+		u.status = UPLOAD_START;
+		u.filename = filename;
+		u.totalSize = 0;
+		u.currentSize = 0;
+		u.buf = NULL;
+		this->routes[r].uploadHandler();
+	}
+
+	if (len > 0 && this->current)
+	{
+		u.status = UPLOAD_WRITE;
+		u.totalSize += len;
+		u.currentSize = len;
+		u.buf = data;
+		this->routes[r].uploadHandler();
+	}
+
+	if (final && this->current)
+	{
+		u.status = UPLOAD_END;
+		u.currentSize = 0;
+		u.buf = NULL;
+		this->routes[r].uploadHandler();
+		this->uploading = NULL;
+	}
+
+	this->inUpload = false;
+	this->current = previous;
+}
+
+//---------------------------------------------------------------------------------------
+// handleBody
+//
+// Called by the async server for every chunk of a non-form request body. The body is
+// collected in the request's temp object (freed by the async server) and made
+// available to the handler as argument "plain", like ESP8266WebServer does.
+//
+// -> request: request the body belongs to
+//    data, len: chunk data
+//    index: offset of this chunk within the body
+//    total: size of the complete body
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::handleBody(AsyncWebServerRequest *request, uint8_t *data,
+	size_t len, size_t index, size_t total)
+{
+	if (total > WEBBACKEND_MAX_BODY) return;
+
+	if (index == 0)
+	{
+		if (request->_tempObject) free(request->_tempObject);
+		request->_tempObject = malloc(total + 1);
+	}
+	if (request->_tempObject == NULL || index + len > total) return;
+
+	memcpy((uint8_t *)request->_tempObject + index, data, len);
+	((char *)request->_tempObject)[index + len] = 0;
+}
+
+//---------------------------------------------------------------------------------------
+// request accessors
+//
+// Same semantics as their ESP8266WebServer counterparts, valid only while a handler
+// is running. The request body is returned as argument "plain".
+//---------------------------------------------------------------------------------------
+bool AsyncWebBackend::hasArg(const char *name)
+{
+	if (!this->current) return false;
+	if (strcmp(name, "plain") == 0) return this->plainBody.length() > 0;
+	return this->current->hasArg(name);
+}
+
+const String& AsyncWebBackend::arg(const char *name)
+{
+	if (!this->current) return this->empty;
+	if (strcmp(name, "plain") == 0) return this->plainBody;
+	return this->current->arg(name);
+}
+
+const String& AsyncWebBackend::arg(int i)
+{
+	if (!this->current) return this->empty;
+	return this->current->arg((size_t)i);
+}
+
+const String& AsyncWebBackend::argName(int i)
+{
+	if (!this->current) return this->empty;
+	return this->current->argName((size_t)i);
+}
+
+int AsyncWebBackend::args()
+{
+	if (!this->current) return 0;
+	return this->current->args();
+}
+
+const String& AsyncWebBackend::uri()
+{
+	return this->currentUri;
+}
+
+int AsyncWebBackend::method()
+{
+	if (!this->current) return METHOD_ANY;
+	return toMethod(this->current->method());
+}
+
+WebUpload& AsyncWebBackend::upload()
+{
+	return this->currentUpload;
+}
+
+//---------------------------------------------------------------------------------------
+// send
+//
+// Sends a response for the current request. Only the first response is sent, this
+// mirrors handlers which reply from both the upload and the request handler.
+//
+// -> code: HTTP status code
+//    contentType: MIME type of content
+//    content: response body
+// <- --
+//---------------------------------------------------------------------------------------
+void AsyncWebBackend::send(int code, const String& contentType, const String& content)
+{
+	if (!this->current || this->responded) return;
+	this->current->send(code, contentType, content);
+	this->responded = true;
+	if (this->inUpload) this->answered = this->current;
+}
+
+//---------------------------------------------------------------------------------------
+// streamFile
+//
+// Sends a file from LittleFS. The async server opens its own handle and sends the
+// file in chunks as the client acknowledges data, the caller may close its handle
+// immediately.
+//
+// -> file: opened file to send
+//    contentType: MIME type of content
+// <- size of the file
+//---------------------------------------------------------------------------------------
+size_t AsyncWebBackend::streamFile(File& file, const String& contentType)
+{
+	if (!this->current || this->responded) return 0;
+	size_t size = file.size();
+	this->current->send(LittleFS, file.fullName(), contentType);
+	this->responded = true;
+	return size;
+}
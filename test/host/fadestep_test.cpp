@@ -0,0 +1,185 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Host test and benchmark for fadestep.h. The packed fade step (fadeLanes() and
+//  fadeStep()) must match the scalar fadeByte() bit for bit. Every current/target
+//  pair is checked in both lanes, then whole frames are faded until they reach the
+//  target. Build and run with "make -C test/host". The benchmark is built like the
+//  firmware (-Os, no auto vectorization), absolute times on the host are of course
+//  far below those on the ESP8266.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include "fadestep.h"
+
+#define NUM_VALUES (114 * 3)          // NUM_PIXELS * 3 as in LEDFunctionsClass
+#define PARTNERS 64                   // values tried in the other lane per pair
+#define FRAMES 2000
+#define BENCH_ITERATIONS 200000
+
+static uint32_t rngState = 0x2545F491;
+static int failures = 0;
+
+//---------------------------------------------------------------------------------------
+// rnd
+//
+// Deterministic xorshift32 random numbers, so failures can be reproduced
+//
+// -> --
+// <- random number
+//---------------------------------------------------------------------------------------
+static uint32_t rnd()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+//---------------------------------------------------------------------------------------
+// fadeScalar
+//
+// Reference: the byte by byte loop fadeStepped() used before the packed version
+//
+// -> current, target, count: see fadeStep()
+// <- --
+//---------------------------------------------------------------------------------------
+static void fadeScalar(uint8_t *current, const uint8_t *target, int count)
+{
+	for (int i = 0; i < count; i++) current[i] = fadeByte(current[i], target[i]);
+}
+
+//---------------------------------------------------------------------------------------
+// testLanes
+//
+// Checks fadeLanes() against fadeByte() for all 65536 current/target pairs in each
+// lane, with random values in the other lane
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+static void testLanes()
+{
+	for (int c = 0; c < 256; c++)
+	{
+		for (int t = 0; t < 256; t++)
+		{
+			for (int p = 0; p < PARTNERS; p++)
+			{
+				uint32_t r = rnd();
+				uint8_t oc = r, ot = r >> 8;
+				for (int lane = 0; lane < 2; lane++)
+				{
+					int shift = lane ? 16 : 0, other = lane ? 0 : 16;
+					uint32_t result = fadeLanes(((uint32_t)c << shift) | ((uint32_t)oc << other),
+						((uint32_t)t << shift) | ((uint32_t)ot << other));
+					if (result != (((uint32_t)fadeByte(c, t) << shift) | ((uint32_t)fadeByte(oc, ot) << other)))
+					{
+						if (++failures <= 20)
+							printf("FAIL fadeLanes lane %d: c=%d t=%d, other c=%d t=%d -> 0x%08X\n",
+								lane, c, t, oc, ot, result);
+					}
+				}
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// testFrames
+//
+// Fades random frames with fadeStep() and fadeScalar() side by side until both reach
+// the target, the buffers must be equal after every step
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+static void testFrames()
+{
+	uint8_t __attribute__((aligned(4))) packed[NUM_VALUES];
+	uint8_t __attribute__((aligned(4))) target[NUM_VALUES];
+	uint8_t scalar[NUM_VALUES];
+
+	for (int frame = 0; frame < FRAMES; frame++)
+	{
+		for (int i = 0; i < NUM_VALUES; i++)
+		{
+			packed[i] = scalar[i] = rnd();
+			target[i] = rnd();
+		}
+
+		for (int step = 0; step < 256; step++)
+		{
+			fadeStep(packed, target, NUM_VALUES);
+			fadeScalar(scalar, target, NUM_VALUES);
+			if (memcmp(packed, scalar, NUM_VALUES) != 0)
+			{
+				if (++failures <= 20) printf("FAIL fadeStep frame %d step %d\n", frame, step);
+				break;
+			}
+		}
+		if (memcmp(packed, target, NUM_VALUES) != 0)
+		{
+			if (++failures <= 20) printf("FAIL fadeStep frame %d did not reach the target\n", frame);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// bench
+//
+// Measures one fade step of a full frame, packed and scalar
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+static void bench()
+{
+	uint8_t __attribute__((aligned(4))) current[NUM_VALUES];
+	uint8_t __attribute__((aligned(4))) target[NUM_VALUES];
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = 0; i < NUM_VALUES; i++)
+		{
+			current[i] = rnd();
+			target[i] = rnd();
+		}
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < BENCH_ITERATIONS; i++)
+		{
+			// swap the direction now and then so the values keep moving
+			if ((i & 255) == 0) current[i % NUM_VALUES] ^= 0xFF;
+			if (pass == 0) fadeStep(current, target, NUM_VALUES);
+			else fadeScalar(current, target, NUM_VALUES);
+			asm volatile("" : : "r"(current) : "memory");
+		}
+		double ns = std::chrono::duration<double, std::nano>(
+			std::chrono::steady_clock::now() - start).count() / BENCH_ITERATIONS;
+		printf("%-10s %7.1f ns/frame (%d values)\n", pass == 0 ? "fadeStep" : "fadeByte", ns, NUM_VALUES);
+	}
+}
+
+int main()
+{
+	testLanes();
+	testFrames();
+	printf("fade step test: %d failures\n", failures);
+
+	bench();
+	return failures ? 1 : 0;
+}
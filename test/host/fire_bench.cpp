@@ -0,0 +1,147 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Host benchmark for the fire kernel (firekernel.cpp). Measures one fireStep() on
+//  the 11x10 matrix for a few settings and fails if it exceeds its budget. At 30 fps
+//  (FIREINTERVAL, 33 ms) the kernel may take DEVICE_BUDGET_NS of a frame on the
+//  ESP8266, the rest belongs to set(), commit(), show(), WiFi and the web server.
+//  The host budget is that time divided by DEVICE_SLOWDOWN, a conservative factor
+//  for an 80 MHz in-order LX106 running from the flash cache against a current
+//  desktop core (about 50x the clock, 3x the instructions per clock, plus margin for
+//  cache misses). Also checks that the fire dies out without sparks and keeps
+//  burning with them. Build and run with "make -C test/host".
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include "firekernel.h"
+
+#define WIDTH 11                       // LEDFunctionsClass::width
+#define HEIGHT 10                      // LEDFunctionsClass::height
+#define FRAME_NS 33000000.0            // FIREINTERVAL
+#define DEVICE_BUDGET_NS 1000000.0     // 1 ms (3% of a frame) for the kernel on the ESP8266
+#define DEVICE_SLOWDOWN 500.0          // ESP8266 time / host time, see above
+#define HOST_BUDGET_NS (DEVICE_BUDGET_NS / DEVICE_SLOWDOWN)
+#define BENCH_FRAMES 200000
+#define BENCH_RUNS 5                   // the fastest run counts, to filter out host noise
+
+static int failures = 0;
+
+//---------------------------------------------------------------------------------------
+// totalHeat
+//
+// Sums up the heat of all cells
+//
+// -> buf: heat buffer
+// <- sum
+//---------------------------------------------------------------------------------------
+static int totalHeat(const uint8_t *buf)
+{
+	int sum = 0;
+	for (int i = 0; i < WIDTH * HEIGHT; i++) sum += buf[i];
+	return sum;
+}
+
+//---------------------------------------------------------------------------------------
+// testBehaviour
+//
+// A burning fire must keep burning while there are sparks and die out without them
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+static void testBehaviour()
+{
+	uint8_t buf[WIDTH * HEIGHT];
+	uint32_t rng = 0x12345678;
+	int16_t windPhase = 0;
+
+	memset(buf, 0, sizeof(buf));
+	for (int frame = 0; frame < 100; frame++) fireStep(buf, WIDTH, HEIGHT, rng, windPhase, 0, 30, 15);
+	if (totalHeat(buf) == 0)
+	{
+		printf("FAIL fire does not burn with sparking 30\n");
+		failures++;
+	}
+
+	for (int frame = 0; frame < 100; frame++) fireStep(buf, WIDTH, HEIGHT, rng, windPhase, 0, 0, 15);
+	if (totalHeat(buf) != 0)
+	{
+		printf("FAIL fire does not die out without sparks\n");
+		failures++;
+	}
+
+	windPhase = 0;
+	for (int frame = 0; frame < 10; frame++) fireStep(buf, WIDTH, HEIGHT, rng, windPhase, -30, 30, 15);
+	if (windPhase != -300 + 3 * FIRE_WINDSTEP)
+	{
+		printf("FAIL wind phase %d after 10 frames of wind -30\n", windPhase);
+		failures++;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// bench
+//
+// Measures fireStep() for a few settings and checks the time against HOST_BUDGET_NS
+//
+// -> --
+// <- --
+//---------------------------------------------------------------------------------------
+static void bench()
+{
+	static const struct { int wind, sparking, cooling; } settings[] = {
+		{ 0, 30, 15 }, { 50, 30, 15 }, { -100, 100, 100 }, { 0, 0, 0 }
+	};
+
+	for (unsigned int s = 0; s < sizeof(settings) / sizeof(settings[0]); s++)
+	{
+		uint8_t buf[WIDTH * HEIGHT];
+		uint32_t rng = 0x12345678;
+		int16_t windPhase = 0;
+		memset(buf, 0, sizeof(buf));
+
+		double ns = 0;
+		for (int run = 0; run < BENCH_RUNS; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (int frame = 0; frame < BENCH_FRAMES; frame++)
+			{
+				fireStep(buf, WIDTH, HEIGHT, rng, windPhase,
+					settings[s].wind, settings[s].sparking, settings[s].cooling);
+				asm volatile("" : : "r"(buf) : "memory");
+			}
+			double t = std::chrono::duration<double, std::nano>(
+				std::chrono::steady_clock::now() - start).count() / BENCH_FRAMES;
+			if (run == 0 || t < ns) ns = t;
+		}
+
+		bool ok = ns <= HOST_BUDGET_NS;
+		printf("%s wind %4d sparking %3d cooling %3d: %6.1f ns/frame, budget %6.1f ns "
+			"(ESP8266 estimate %.0f us = %.1f%% of the 33 ms frame)\n", ok ? "ok  " : "FAIL",
+			settings[s].wind, settings[s].sparking, settings[s].cooling, ns, HOST_BUDGET_NS,
+			ns * DEVICE_SLOWDOWN / 1000.0, 100.0 * ns * DEVICE_SLOWDOWN / FRAME_NS);
+		if (!ok) failures++;
+	}
+}
+
+int main()
+{
+	testBehaviour();
+	bench();
+	printf("fire kernel test: %d failures\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,308 @@
+// ESP8266 Wordclock
+// Copyright (C) 2016 Thoralt Franz, https://github.com/thoralt
+//
+//  Host fuzz test and benchmark for the argument parsers in parse.cpp. Random and
+//  mutated strings are fed to every parser and the result is compared with a
+//  straightforward reference built on the C library. Build and run with
+//  "make -C test/host".
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include <chrono>
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "parse.h"
+
+#define FUZZ_ITERATIONS 2000000
+#define BENCH_ITERATIONS 2000000
+#define MAX_INPUT 24
+
+static uint32_t rngState = 0x12345678;
+static int failures = 0;
+
+//---------------------------------------------------------------------------------------
+// rnd
+//
+// Deterministic xorshift32 random numbers, so failures can be reproduced
+//
+// -> n: upper bound (exclusive)
+// <- random number 0..n-1
+//---------------------------------------------------------------------------------------
+static uint32_t rnd(uint32_t n)
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState % n;
+}
+
+//---------------------------------------------------------------------------------------
+// isDigits
+//
+// Checks if a range of characters consists of decimal or hexadecimal digits only
+//
+// -> s: start of range
+//    len: number of characters
+//    hex: accept hexadecimal digits
+// <- true if len > 0 and all characters are digits
+//---------------------------------------------------------------------------------------
+static bool isDigits(const char *s, size_t len, bool hex)
+{
+	if (len == 0) return false;
+	for (size_t i = 0; i < len; i++)
+	{
+		if (hex ? !isxdigit((unsigned char)s[i]) : !isdigit((unsigned char)s[i])) return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// Reference implementations, written for clarity rather than speed
+//---------------------------------------------------------------------------------------
+static bool refHexColor(const char *s, uint8_t &r, uint8_t &g, uint8_t &b)
+{
+	if (*s == '#') s++;
+	if (strlen(s) != 6 || !isDigits(s, 6, true)) return false;
+	unsigned long v = strtoul(s, NULL, 16);
+	r = v >> 16;
+	g = v >> 8;
+	b = v;
+	return true;
+}
+
+static bool refInt(const char *s, long &result, long min, long max)
+{
+	const char *digits = (*s == '-' || *s == '+') ? s + 1 : s;
+	if (!isDigits(digits, strlen(digits), false)) return false;
+	errno = 0;
+	long long v = strtoll(s, NULL, 10);
+	if (errno == ERANGE || v < min || v > max) return false;
+	result = v;
+	return true;
+}
+
+static bool refHex32(const char *s, uint32_t &result)
+{
+	if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) s += 2;
+	size_t len = strlen(s);
+	if (len > 8 || !isDigits(s, len, true)) return false;
+	result = strtoul(s, NULL, 16);
+	return true;
+}
+
+static bool refIP(const char *s, uint8_t ip[4])
+{
+	uint8_t v[4];
+	for (int i = 0; i < 4; i++)
+	{
+		const char *end = strchr(s, i < 3 ? '.' : 0);
+		if (!end) return false;
+		size_t len = end - s;
+		if (len > 3 || !isDigits(s, len, false)) return false;
+		if (atoi(s) > 255) return false;
+		v[i] = atoi(s);
+		s = end + (i < 3 ? 1 : 0);
+	}
+	memcpy(ip, v, 4);
+	return true;
+}
+
+static bool refBool(const char *s, bool &result)
+{
+	static const char *yes[] = { "1", "on", "true", "yes" };
+	static const char *no[] = { "0", "off", "false", "no" };
+	for (int i = 0; i < 4; i++)
+	{
+		if (strcasecmp(s, yes[i]) == 0) { result = true; return true; }
+		if (strcasecmp(s, no[i]) == 0) { result = false; return true; }
+	}
+	return false;
+}
+
+static bool refTime(const char *s, int &h, int &m)
+{
+	const char *colon = strchr(s, ':');
+	if (!colon) return false;
+	size_t hl = colon - s;
+	if (hl < 1 || hl > 2 || !isDigits(s, hl, false)) return false;
+	if (strlen(colon + 1) != 2 || !isDigits(colon + 1, 2, false)) return false;
+	int hours = atoi(s), minutes = atoi(colon + 1);
+	if (hours > 23 || minutes > 59) return false;
+	h = hours;
+	m = minutes;
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+// makeInput
+//
+// Creates a fuzz input: either a mutation of a valid example or a random string over
+// an alphabet that is likely to hit the parser's edge cases
+//
+// -> buf: receives the zero terminated input (MAX_INPUT + 1 bytes)
+//---------------------------------------------------------------------------------------
+static void makeInput(char *buf)
+{
+	static const char *seeds[] = {
+		"#1a2B3c", "ff8000", "0", "-42", "+17", "2147483647", "-2147483648",
+		"0xDEADbeef", "12345678", "192.168.1.10", "255.255.255.255", "0.0.0.0",
+		"on", "OFF", "True", "no", "7:05", "23:59", "00:00"
+	};
+	static const char alphabet[] = "0123456789abcdefABCDEFxX#:.+- gGnNoOtTrRuUeEyYsSlL";
+
+	if (rnd(2))
+	{
+		strcpy(buf, seeds[rnd(sizeof(seeds) / sizeof(seeds[0]))]);
+		int mutations = 1 + rnd(3);
+		for (int i = 0; i < mutations; i++)
+		{
+			size_t len = strlen(buf);
+			size_t pos = rnd(len + 1);
+			switch (rnd(3))
+			{
+			case 0: // replace
+				if (len > 0) buf[pos % len] = alphabet[rnd(sizeof(alphabet) - 1)];
+				break;
+			case 1: // insert
+				if (len < MAX_INPUT)
+				{
+					memmove(buf + pos + 1, buf + pos, len - pos + 1);
+					buf[pos] = alphabet[rnd(sizeof(alphabet) - 1)];
+				}
+				break;
+			default: // delete
+				if (len > 0) memmove(buf + pos % len, buf + pos % len + 1, len - pos % len);
+				break;
+			}
+		}
+	}
+	else
+	{
+		int len = rnd(MAX_INPUT + 1);
+		for (int i = 0; i < len; i++) buf[i] = alphabet[rnd(sizeof(alphabet) - 1)];
+		buf[len] = 0;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// fail
+//
+// Reports a mismatch between parser and reference
+//
+// -> parser: name of the parser
+//    input: offending input
+//---------------------------------------------------------------------------------------
+static void fail(const char *parser, const char *input)
+{
+	if (++failures <= 20) printf("FAIL %s(\"%s\")\n", parser, input);
+}
+
+//---------------------------------------------------------------------------------------
+// fuzz
+//
+// Runs all parsers and their references on the same input and compares the return
+// value, the result and that the result is untouched on invalid input
+//
+// -> s: input string
+//---------------------------------------------------------------------------------------
+static void fuzz(const char *s)
+{
+	uint8_t r = 1, g = 2, b = 3, rr = 1, rg = 2, rb = 3;
+	if (parseHexColor(s, r, g, b) != refHexColor(s, rr, rg, rb) || r != rr || g != rg || b != rb)
+		fail("parseHexColor", s);
+
+	static const long ranges[][2] = { { 0, 255 }, { -100, 100 }, { 1, 65535 },
+		{ -2147483647L - 1, 2147483647L }, { 10, 20 } };
+	const long *range = ranges[rnd(sizeof(ranges) / sizeof(ranges[0]))];
+	long l = 12345, rl = 12345;
+	if (parseInt(s, l, range[0], range[1]) != refInt(s, rl, range[0], range[1]) || l != rl)
+		fail("parseInt", s);
+
+	uint32_t h = 0xA5A5A5A5, rh = 0xA5A5A5A5;
+	if (parseHex32(s, h) != refHex32(s, rh) || h != rh)
+		fail("parseHex32", s);
+
+	uint8_t ip[4] = { 9, 9, 9, 9 }, rip[4] = { 9, 9, 9, 9 };
+	if (parseIP(s, ip) != refIP(s, rip) || memcmp(ip, rip, 4) != 0)
+		fail("parseIP", s);
+
+	bool v = false, rv = false;
+	if (parseBool(s, v) != refBool(s, rv) || v != rv)
+		fail("parseBool", s);
+
+	int hh = 99, mm = 99, rhh = 99, rmm = 99;
+	if (parseTime(s, hh, mm) != refTime(s, rhh, rmm) || hh != rhh || mm != rmm)
+		fail("parseTime", s);
+}
+
+//---------------------------------------------------------------------------------------
+// bench
+//
+// Measures the average time of one call of each parser on a valid argument
+//---------------------------------------------------------------------------------------
+static void bench()
+{
+	volatile uint32_t sink = 0;
+	uint8_t r, g, b, ip[4];
+	long l;
+	uint32_t h;
+	bool v;
+	int hh, mm;
+
+	struct { const char *name; const char *input; } cases[] = {
+		{ "parseHexColor", "#1a2B3c" }, { "parseInt", "-1234" }, { "parseHex32", "0xDEADbeef" },
+		{ "parseIP", "192.168.100.200" }, { "parseBool", "false" }, { "parseTime", "23:59" }
+	};
+
+	for (int c = 0; c < 6; c++)
+	{
+		const char *s = cases[c].input;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < BENCH_ITERATIONS; i++)
+		{
+			switch (c)
+			{
+			case 0: sink += parseHexColor(s, r, g, b); break;
+			case 1: sink += parseInt(s, l, -100000, 100000); break;
+			case 2: sink += parseHex32(s, h); break;
+			case 3: sink += parseIP(s, ip); break;
+			case 4: sink += parseBool(s, v); break;
+			default: sink += parseTime(s, hh, mm); break;
+			}
+		}
+		double ns = std::chrono::duration<double, std::nano>(
+			std::chrono::steady_clock::now() - start).count() / BENCH_ITERATIONS;
+		printf("%-14s %-18s %6.1f ns/call\n", cases[c].name, s, ns);
+	}
+	(void)sink;
+}
+
+int main()
+{
+	char input[MAX_INPUT + 1];
+
+	for (int i = 0; i < FUZZ_ITERATIONS; i++)
+	{
+		makeInput(input);
+		fuzz(input);
+	}
+	printf("parse fuzz: %d inputs, %d failures\n", FUZZ_ITERATIONS, failures);
+
+	bench();
+	return failures ? 1 : 0;
+}